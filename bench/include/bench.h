@@ -0,0 +1,33 @@
+// Shared helpers for the benchmark executable
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Monotonic wall clock in nanoseconds
+static inline double NowNs() {
+    using namespace std::chrono;
+    return (double)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Keeps the optimizer from dropping a result we only compute for timing
+template <typename T>
+static inline void KeepAlive(const T& value) {
+    const volatile uint8_t* p = (const volatile uint8_t*)&value;
+    (void)*p;
+}
+
+// Command-line options shared by the benchmarks
+struct BenchOptions {
+    const char* jsonPath = nullptr;   // --json FILE: machine-readable results (benchmarks that support it)
+    bool        quick = false;        // --quick: skip the largest sizes
+    int         threads = 1;          // --threads N: worker threads for the physics step (0 = all cores)
+};
+extern BenchOptions benchOptions;
+
+// Benchmarks (one per file in src/)
+int RunSoABenchmark();
+int RunIntegrateBenchmark();
+int RunSceneBenchmark();
+int RunSnapshotBenchmark();
+int RunExplodeBenchmark();
@@ -0,0 +1,93 @@
+// Explosion queries: a batch of blasts scattered over the scene, each
+// finding the bodies within its radius, first by scanning every body and
+// then through QueryCircle on each broadphase (plus the static index).
+// The queries see the boxes of the step before, so their hit counts can
+// differ from the scan's by the few bodies that moved in or out since.
+#include "bench.h"
+#include "scenes.h"
+#include "simulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+static const int SETTLE_STEPS = 20;
+static const int BLASTS = 32;             // per batch
+static const float BLAST_RADIUS = 120.0f;
+
+// What an explosion has to do without the broadphase: look at every body
+static int ScanCircle(Vector2 center, float radius, vector<int>& out) {
+    out.clear();
+    for (int i = 0; i < bodies.Count(); ++i) {
+        if (!bodies.active[i] || bodies.shape[i].type == SHAPE_CHAIN) continue;
+        Vector2 lo, hi;
+        bodies.LocalBounds(i, lo, hi);
+        Vector2 p = bodies.position[i];
+        float dx = max(max(p.x + lo.x - center.x, center.x - (p.x + hi.x)), 0.0f);
+        float dy = max(max(p.y + lo.y - center.y, center.y - (p.y + hi.y)), 0.0f);
+        if (dx * dx + dy * dy <= radius * radius) out.push_back(i);
+    }
+    return (int)out.size();
+}
+
+int RunExplodeBenchmark() {
+    const int sizes[] = { 1000, 10000, 100000 };
+    const int sizeCount = benchOptions.quick ? 2 : 3;
+    const SceneKind kinds[] = { SCENE_PYRAMIDS, SCENE_BALL_PIT };
+
+    jobs.Start(benchOptions.threads);
+    physicsHz = 50.0f;
+    dt = 1.0f / physicsHz;
+
+    printf("%-9s %7s %-16s %12s %12s %8s %8s\n", "scene", "bodies", "broadphase", "scan ns", "query ns",
+        "speedup", "hits");
+
+    for (SceneKind kind : kinds) {
+        for (int s = 0; s < sizeCount; ++s) {
+            BuildScene(kind, sizes[s]);
+            for (int i = 0; i < SETTLE_STEPS; ++i) UpdatePhysics();
+
+            // blasts spread evenly over the bodies' extent, just above the ground
+            float left = bodies.position[0].x, right = left;
+            for (int i = 0; i < bodies.Count(); ++i) {
+                left = min(left, bodies.position[i].x);
+                right = max(right, bodies.position[i].x);
+            }
+            vector<Vector2> centers(BLASTS);
+            for (int k = 0; k < BLASTS; ++k) {
+                centers[k] = { left + (right - left) * (k + 0.5f) / BLASTS, groundY - BLAST_RADIUS * 0.5f };
+            }
+
+            vector<int> hits;
+            int scanHits = 0;
+            double t0 = NowNs();
+            for (const Vector2& c : centers) scanHits += ScanCircle(c, BLAST_RADIUS, hits);
+            double scanNs = NowNs() - t0;
+
+            for (int m = BROADPHASE_BRUTE_FORCE; m < BROADPHASE_COUNT; ++m) {
+                broadphaseMode = (BroadphaseMode)m;
+                UpdatePhysics();   // brings this broadphase up to date
+
+                int queryHits = 0;
+                t0 = NowNs();
+                for (const Vector2& c : centers) {
+                    QueryCircle(c, BLAST_RADIUS, hits);
+                    queryHits += (int)hits.size();
+                }
+                double queryNs = NowNs() - t0;
+                KeepAlive(queryHits);
+
+                printf("%-9s %7d %-16s %12.0f %12.0f %7.1fx %8d\n", SceneName(kind), bodies.Count(),
+                    BroadphaseModeName(broadphaseMode), scanNs, queryNs, scanNs / queryNs, queryHits);
+                fflush(stdout);
+            }
+            KeepAlive(scanHits);
+            broadphaseMode = BROADPHASE_GRID;
+        }
+    }
+    jobs.Stop();
+    return 0;
+}
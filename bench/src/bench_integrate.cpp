@@ -0,0 +1,85 @@
+// Integration + rest-clamp kernels at every SIMD level the CPU supports.
+// Reports bodies per second and checks each level against scalar bit-for-bit.
+#include "bench.h"
+#include "body_store.h"
+#include "simd_integrate.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+static const float BENCH_DT = 1.0f / 50.0f;
+static const float BENCH_GRAVITY = 600.0f;
+static const float BENCH_REST_EPS = 0.02f;
+
+static void MakeStore(int count, BodyStore& store) {
+    srand(4321);
+    store.Clear();
+    store.Reserve(count);
+    for (int i = 0; i < count; ++i) {
+        Body b;
+        b.position = { (float)(rand() % 4000), (float)(rand() % 2000) };
+        // a quarter of the bodies come to rest after the first gravity step,
+        // so the clamp has work to do
+        if (i % 4 == 0) b.velocity = { 0.01f, -BENCH_GRAVITY * BENCH_DT + 0.005f };
+        else            b.velocity = { (float)(rand() % 200 - 100), (float)(rand() % 200 - 100) };
+        b.mass = (i % 20 == 0) ? 0.0f : 4.0f;
+        b.invMass = (b.mass > 0.0f) ? 1.0f / b.mass : 0.0f;
+        b.active = (i % 50 != 0);
+        store.Add(b);
+    }
+}
+
+static void Step(BodyStore& s) {
+    IntegrateBodies(s.position.data(), s.velocity.data(), s.invMass.data(), s.active.data(),
+        s.Count(), BENCH_GRAVITY, BENCH_DT);
+    DampSmallVelocities(s.velocity.data(), s.invMass.data(), s.active.data(), s.Count(), BENCH_REST_EPS);
+}
+
+int RunIntegrateBenchmark() {
+    const int sizes[] = { 10000, 100000 };
+    const SimdLevel best = DetectSimdLevel();
+    const SimdLevel saved = GetSimdLevel();
+
+    printf("best level on this CPU: %s\n", SimdLevelName(best));
+    printf("%-8s %-8s %14s %10s %8s\n", "bodies", "level", "Mbodies/s", "speedup", "match");
+
+    int failures = 0;
+    for (int count : sizes) {
+        // scalar reference after a few steps, for the bit-exact check
+        BodyStore reference;
+        MakeStore(count, reference);
+        SetSimdLevel(SIMD_SCALAR);
+        for (int s = 0; s < 8; ++s) Step(reference);
+
+        double scalarRate = 0.0;
+        for (int level = SIMD_SCALAR; level <= best; ++level) {
+            SetSimdLevel((SimdLevel)level);
+
+            BodyStore store;
+            MakeStore(count, store);
+            for (int s = 0; s < 8; ++s) Step(store);
+            bool match =
+                memcmp(store.position.data(), reference.position.data(), count * sizeof(Vector2)) == 0 &&
+                memcmp(store.velocity.data(), reference.velocity.data(), count * sizeof(Vector2)) == 0;
+            if (!match) ++failures;
+
+            int reps = (int)(20000000LL / count);
+            double t0 = NowNs();
+            for (int r = 0; r < reps; ++r) Step(store);
+            double t1 = NowNs();
+            KeepAlive(store.position[count / 2]);
+
+            double rate = (double)reps * count / ((t1 - t0) * 1e-9);
+            if (level == SIMD_SCALAR) scalarRate = rate;
+            printf("%-8d %-8s %14.1f %9.2fx %8s\n", count, SimdLevelName((SimdLevel)level),
+                rate * 1e-6, rate / scalarRate, match ? "yes" : "NO");
+        }
+    }
+
+    SetSimdLevel(saved);
+    return (failures == 0) ? 0 : 1;
+}
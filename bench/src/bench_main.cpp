@@ -0,0 +1,52 @@
+// Benchmark runner: bench [name] [--json FILE] [--quick] [--threads N]
+// (no name = run everything)
+#include "bench.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+BenchOptions benchOptions;
+
+struct BenchEntry {
+    const char* name;
+    int (*run)();
+};
+
+static const BenchEntry benches[] = {
+    { "soa", RunSoABenchmark },
+    { "integrate", RunIntegrateBenchmark },
+    { "scenes", RunSceneBenchmark },
+    { "snapshot", RunSnapshotBenchmark },
+    { "explode", RunExplodeBenchmark },
+};
+
+int main(int argc, char** argv) {
+    const char* only = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)         benchOptions.jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) benchOptions.threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--quick") == 0)                   benchOptions.quick = true;
+        else if (argv[i][0] != '-' && !only)                        only = argv[i];
+        else {
+            printf("usage: bench [name] [--json FILE] [--quick] [--threads N]\n");
+            return 1;
+        }
+    }
+
+    int ran = 0;
+    for (const BenchEntry& b : benches) {
+        if (only && strcmp(only, b.name) != 0) continue;
+        printf("== %s ==\n", b.name);
+        if (b.run() != 0) return 1;
+        ++ran;
+    }
+
+    if (ran == 0) {
+        printf("unknown benchmark '%s', available:", only);
+        for (const BenchEntry& b : benches) printf(" %s", b.name);
+        printf("\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+// Full physics step (UpdatePhysics) on the synthetic scenes at 100 to 100k
+// bodies. Reports ns/step with the broadphase / narrowphase / solver split
+// and the average pair and contact counts; --json writes the same numbers
+// for tracking regressions across commits.
+#include "bench.h"
+#include "profiler.h"
+#include "scenes.h"
+#include "simd_integrate.h"
+#include "simulation.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+static const int WARMUP_STEPS = 5;
+
+struct SceneResult {
+    SceneKind kind;
+    int    bodies;
+    int    steps;
+    double nsPerStep;
+    double minNs;
+    double maxNs;
+    double broadphaseNs;   // per step, averaged
+    double narrowphaseNs;
+    double solverNs;
+    double pairs;          // per step, averaged
+    double contacts;
+    int    manifolds;      // at the end
+    int    sleeping;
+};
+
+// Enough steps for a stable average without the 100k runs taking minutes
+static int StepsFor(int count) {
+    return max(10, min(200, 2000000 / count));
+}
+
+static SceneResult RunScene(SceneKind kind, int count) {
+    physicsHz = 50.0f;
+    dt = 1.0f / physicsHz;
+    timeElapsed = 0.0f;
+    BuildScene(kind, count);
+    for (int s = 0; s < WARMUP_STEPS; ++s) {
+        UpdatePhysics();
+        profiler.EndFrame();
+    }
+
+    SceneResult r{};
+    r.kind = kind;
+    r.bodies = count;
+    r.steps = StepsFor(count);
+    r.minNs = 1e30;
+
+    double total = 0.0, pairs = 0.0, hits = 0.0;
+    for (int s = 0; s < r.steps; ++s) {
+        double t0 = NowNs();
+        UpdatePhysics();
+        double ns = NowNs() - t0;
+        profiler.EndFrame();
+
+        total += ns;
+        r.minNs = min(r.minNs, ns);
+        r.maxNs = max(r.maxNs, ns);
+        r.broadphaseNs += profiler.Last(PHASE_BROADPHASE);
+        r.narrowphaseNs += profiler.Last(PHASE_NARROWPHASE);
+        r.solverNs += profiler.Last(PHASE_SOLVE);
+        pairs += (double)candidatePairs.size();
+        hits += (int)contacts.size();
+    }
+    KeepAlive(bodies.position[bodies.Count() / 2]);
+
+    r.nsPerStep = total / r.steps;
+    r.broadphaseNs /= r.steps;
+    r.narrowphaseNs /= r.steps;
+    r.solverNs /= r.steps;
+    r.pairs = pairs / r.steps;
+    r.contacts = hits / r.steps;
+    r.manifolds = (int)manifoldCache.manifolds.size();
+    r.sleeping = islands.sleepingCount;
+    return r;
+}
+
+static bool WriteJson(const char* path, const vector<SceneResult>& results) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+
+    fprintf(f, "{\n  \"benchmark\": \"scenes\",\n");
+    fprintf(f, "  \"simd\": \"%s\",\n  \"threads\": %d,\n  \"broadphase\": \"%s\",\n  \"physics_hz\": %.0f,\n",
+        SimdLevelName(GetSimdLevel()), jobs.ThreadCount(), BroadphaseModeName(broadphaseMode), physicsHz);
+    fprintf(f, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const SceneResult& r = results[i];
+        fprintf(f, "    { \"scene\": \"%s\", \"bodies\": %d, \"steps\": %d, \"ns_per_step\": %.0f, "
+            "\"min_ns\": %.0f, \"max_ns\": %.0f, \"broadphase_ns\": %.0f, \"narrowphase_ns\": %.0f, "
+            "\"solver_ns\": %.0f, \"pairs\": %.1f, \"contacts\": %.1f, \"manifolds\": %d, \"sleeping\": %d }%s\n",
+            SceneName(r.kind), r.bodies, r.steps, r.nsPerStep, r.minNs, r.maxNs, r.broadphaseNs,
+            r.narrowphaseNs, r.solverNs, r.pairs, r.contacts, r.manifolds, r.sleeping,
+            (i + 1 < results.size()) ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return true;
+}
+
+int RunSceneBenchmark() {
+    const int sizes[] = { 100, 1000, 10000, 100000 };
+    const int sizeCount = benchOptions.quick ? 3 : 4;
+
+    jobs.Start(benchOptions.threads);
+    printf("threads %d  |  SIMD %s  |  %s\n", jobs.ThreadCount(), SimdLevelName(GetSimdLevel()),
+        BroadphaseModeName(broadphaseMode));
+    printf("%-9s %7s %6s %12s %12s %12s %12s %10s %10s\n", "scene", "bodies", "steps",
+        "ns/step", "broad ns", "narrow ns", "solver ns", "pairs", "contacts");
+
+    vector<SceneResult> results;
+    for (int k = 0; k < SCENE_COUNT; ++k) {
+        for (int s = 0; s < sizeCount; ++s) {
+            SceneResult r = RunScene((SceneKind)k, sizes[s]);
+            printf("%-9s %7d %6d %12.0f %12.0f %12.0f %12.0f %10.1f %10.1f\n", SceneName(r.kind), r.bodies,
+                r.steps, r.nsPerStep, r.broadphaseNs, r.narrowphaseNs, r.solverNs, r.pairs, r.contacts);
+            fflush(stdout);
+            results.push_back(r);
+        }
+    }
+    jobs.Stop();
+
+    if (benchOptions.jsonPath) {
+        if (!WriteJson(benchOptions.jsonPath, results)) {
+            printf("could not write %s\n", benchOptions.jsonPath);
+            return 1;
+        }
+        printf("wrote %s\n", benchOptions.jsonPath);
+    }
+    return 0;
+}
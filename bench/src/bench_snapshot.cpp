@@ -0,0 +1,61 @@
+// World snapshots on the synthetic scenes: keyframe save, delta save and
+// restore times, and the bytes per body of each blob against the raw Body
+// struct. The scene is stepped a while first so the delta covers a mix of
+// moving and resting bodies.
+#include "bench.h"
+#include "scenes.h"
+#include "simulation.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+static const int SETTLE_STEPS = 20;    // before the keyframe
+static const int DELTA_STEPS = 10;     // keyframe -> delta
+
+// Average ns of fn over enough repeats to be measurable
+template <typename Fn>
+static double TimeNs(int count, Fn fn) {
+    int repeats = max(3, min(200, 200000 / count));
+    double t0 = NowNs();
+    for (int r = 0; r < repeats; ++r) fn();
+    return (NowNs() - t0) / repeats;
+}
+
+int RunSnapshotBenchmark() {
+    const int sizes[] = { 100, 1000, 10000, 100000 };
+    const int sizeCount = benchOptions.quick ? 3 : 4;
+
+    jobs.Start(benchOptions.threads);
+    physicsHz = 50.0f;
+    dt = 1.0f / physicsHz;
+
+    printf("%-9s %7s %10s %10s %10s %9s %9s %9s\n", "scene", "bodies", "key ns", "delta ns",
+        "restore ns", "key B/b", "delta B/b", "raw B/b");
+
+    for (int k = 0; k < SCENE_COUNT; ++k) {
+        for (int s = 0; s < sizeCount; ++s) {
+            BuildScene((SceneKind)k, sizes[s]);
+            for (int i = 0; i < SETTLE_STEPS; ++i) UpdatePhysics();
+
+            vector<uint8_t> key, delta;
+            SnapshotKeyState keyState;
+            const int n = bodies.Count();
+            double keyNs = TimeNs(n, [&] { SaveSnapshot(key, &keyState); });
+
+            for (int i = 0; i < DELTA_STEPS; ++i) UpdatePhysics();
+            double deltaNs = TimeNs(n, [&] { SaveDeltaSnapshot(keyState, delta); });
+            double restoreNs = TimeNs(n, [&] { RestoreSnapshot(key, &delta); });
+            KeepAlive(bodies.position[n / 2]);
+
+            printf("%-9s %7d %10.0f %10.0f %10.0f %9.1f %9.1f %9d\n", SceneName((SceneKind)k), n,
+                keyNs, deltaNs, restoreNs, (double)key.size() / n, (double)delta.size() / n, (int)sizeof(Body));
+            fflush(stdout);
+        }
+    }
+    jobs.Stop();
+    return 0;
+}
@@ -0,0 +1,154 @@
+// vector<Body> (array of structs) vs BodyStore (structure of arrays)
+// on the two per-body passes of UpdatePhysics that touch every body:
+// gravity + Euler integration, and building broadphase bounds.
+#include "bench.h"
+#include "body_store.h"
+#include "broadphase.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+
+static const float BENCH_DT = 1.0f / 50.0f;
+static const float BENCH_GRAVITY = 600.0f;
+
+// Same mix of bodies in both layouts: mostly blocks, some circles,
+// a few statics and a few inactive (dead) bodies
+static void MakeBodies(int count, vector<Body>& aos, BodyStore& soa) {
+    srand(1234);
+    aos.clear();
+    soa.Clear();
+    aos.reserve(count);
+    soa.Reserve(count);
+
+    for (int i = 0; i < count; ++i) {
+        Body b;
+        b.position = { (float)(rand() % 4000), (float)(rand() % 2000) };
+        b.velocity = { (float)(rand() % 200 - 100), (float)(rand() % 200 - 100) };
+        b.shape = (i % 4 == 0) ? SHAPE_CIRCLE : SHAPE_AABB;
+        b.radius = 12.0f;
+        b.halfExtents = { 25.0f, 25.0f };
+        b.mass = (i % 20 == 0) ? 0.0f : 4.0f;
+        b.invMass = (b.mass > 0.0f) ? 1.0f / b.mass : 0.0f;
+        b.active = (i % 50 != 0);
+        aos.push_back(b);
+        soa.Add(b);
+    }
+}
+
+// ------------------------------------------------------------
+// Integration pass (matches the first loop of UpdatePhysics)
+
+static void IntegrateAoS(vector<Body>& bodies) {
+    for (auto& b : bodies) {
+        if (!b.active) continue;
+        if (b.invMass == 0.0f) continue;
+        b.position.x += b.velocity.x * BENCH_DT;
+        b.position.y += b.velocity.y * BENCH_DT;
+        b.velocity.y += BENCH_GRAVITY * BENCH_DT;
+    }
+}
+
+static void IntegrateSoA(BodyStore& bodies) {
+    const int n = bodies.Count();
+    Vector2* pos = bodies.position.data();
+    Vector2* vel = bodies.velocity.data();
+    const float* invMass = bodies.invMass.data();
+    const uint8_t* active = bodies.active.data();
+    for (int i = 0; i < n; ++i) {
+        if (!active[i]) continue;
+        if (invMass[i] == 0.0f) continue;
+        pos[i].x += vel[i].x * BENCH_DT;
+        pos[i].y += vel[i].y * BENCH_DT;
+        vel[i].y += BENCH_GRAVITY * BENCH_DT;
+    }
+}
+
+// ------------------------------------------------------------
+// Bounds pass (matches the broadphase proxy build): a world-space box per
+// active body, written out as a proxy. The boxes are stored, so the
+// compiler can't drop the pass, and every rep builds the whole list again.
+
+static void BoundsAoS(const vector<Body>& bodies, vector<BroadphaseProxy>& out) {
+    out.clear();
+    for (int i = 0; i < (int)bodies.size(); ++i) {
+        const Body& b = bodies[i];
+        if (!b.active) continue;
+        Vector2 half = (b.shape == SHAPE_CIRCLE) ? Vector2{ b.radius, b.radius } : b.halfExtents;
+        BroadphaseProxy proxy;
+        proxy.box.min = { b.position.x - half.x, b.position.y - half.y };
+        proxy.box.max = { b.position.x + half.x, b.position.y + half.y };
+        proxy.body = i;
+        proxy.isStatic = (b.invMass == 0.0f);
+        out.push_back(proxy);
+    }
+}
+
+static void BoundsSoA(const BodyStore& bodies, vector<BroadphaseProxy>& out) {
+    out.clear();
+    const int n = bodies.Count();
+    for (int i = 0; i < n; ++i) {
+        if (!bodies.active[i]) continue;
+        const BodyShape& s = bodies.shape[i];
+        Vector2 half = (s.type == SHAPE_CIRCLE) ? Vector2{ s.radius, s.radius } : s.halfExtents;
+        Vector2 p = bodies.position[i];
+        BroadphaseProxy proxy;
+        proxy.box.min = { p.x - half.x, p.y - half.y };
+        proxy.box.max = { p.x + half.x, p.y + half.y };
+        proxy.body = i;
+        proxy.isStatic = (bodies.invMass[i] == 0.0f);
+        out.push_back(proxy);
+    }
+}
+
+// ------------------------------------------------------------
+
+template <typename Fn>
+static double TimePerBody(int count, int reps, Fn fn) {
+    fn(); // warm up caches
+    double t0 = NowNs();
+    for (int r = 0; r < reps; ++r) fn();
+    double t1 = NowNs();
+    return (t1 - t0) / ((double)reps * count);
+}
+
+int RunSoABenchmark() {
+    const int sizes[] = { 10000, 100000 };
+
+    printf("%-8s %-10s %12s %12s %9s\n", "bodies", "pass", "AoS ns/body", "SoA ns/body", "speedup");
+    for (int count : sizes) {
+        vector<Body> aos;
+        BodyStore soa;
+        MakeBodies(count, aos, soa);
+
+        // keep the total work roughly constant across sizes
+        int reps = (int)(20000000LL / count);
+
+        double aosInt = TimePerBody(count, reps, [&]() { IntegrateAoS(aos); });
+        double soaInt = TimePerBody(count, reps, [&]() { IntegrateSoA(soa); });
+        printf("%-8d %-10s %12.3f %12.3f %8.2fx\n", count, "integrate", aosInt, soaInt, aosInt / soaInt);
+
+        // one box list per rep, read back in between so each list is needed
+        vector<BroadphaseProxy> proxies;
+        proxies.reserve(count);
+        float sinkA = 0.0f, sinkS = 0.0f;
+        double aosBox = TimePerBody(count, reps, [&]() {
+            BoundsAoS(aos, proxies);
+            sinkA += proxies[(size_t)sinkA % proxies.size()].box.max.x;
+        });
+        double soaBox = TimePerBody(count, reps, [&]() {
+            BoundsSoA(soa, proxies);
+            sinkS += proxies[(size_t)sinkS % proxies.size()].box.max.x;
+        });
+        printf("%-8d %-10s %12.3f %12.3f %8.2fx\n", count, "bounds", aosBox, soaBox, aosBox / soaBox);
+
+        KeepAlive(sinkA);
+        KeepAlive(sinkS);
+        KeepAlive(aos[count / 2].position);
+        KeepAlive(soa.position[count / 2]);
+    }
+    return 0;
+}
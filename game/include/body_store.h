@@ -0,0 +1,197 @@
+// Body storage: every per-body field the physics step touches lives in its
+// own contiguous array (structure of arrays), so the integrator and the
+// broadphase only stream the data they actually use.
+//
+// Bodies are referred to from outside the step by generational handles.
+// Removing a body frees its handle at once (the generation is bumped, so
+// stale copies stop resolving) and the id goes on a free list for the next
+// Add; the body itself stays in the arrays, inactive, until Compact packs
+// the live bodies down. The arrays keep their capacity, so a long session
+// of spawning and removing settles into reusing the same memory.
+//
+// Orientation is kept as a unit (cos, sin) pair (see polygon.h). Polygon
+// shapes live once in a pool that bodies point into, so a tower of equal
+// blocks shares one polygon.
+#pragma once
+
+#include "raylib.h"
+#include "polygon.h"
+#include <cstdint>
+#include <vector>
+
+enum ShapeType {
+    SHAPE_CIRCLE,
+    SHAPE_AABB,      // never rotates (ground, walls)
+    SHAPE_POLYGON,   // convex, rotates; boxes are 4-vertex polygons
+    SHAPE_CHAIN      // static terrain polyline (terrain.h), never rotates
+};
+
+enum ObjectType {
+    OBJ_BIRD,
+    OBJ_BLOCK,
+    OBJ_PIG,
+    OBJ_STATIC_TERRAIN
+};
+
+// Full description of one body (array-of-structs layout).
+// MakeCircle / MakeAABB / MakeBox / MakePolygon fill one in and
+// BodyStore::Add splits it up.
+struct Body {
+    // physics state
+    Vector2 position{ 0.0f, 0.0f };
+    Vector2 velocity{ 0.0f, 0.0f };
+    float   angle = 0.0f;             // radians, ignored for AABBs
+    float   angularVelocity = 0.0f;   // radians/s
+
+    // geometry
+    float   radius = 8.0f;        // for circles
+    Vector2 halfExtents{ 10.0f, 10.0f }; // for AABBs
+    ConvexPolygon polygon;        // for polygons (body space)
+    int     chain = -1;           // for chains: index into the world's terrain
+
+    // physics properties
+    float   mass = 1.0f;
+    float   invMass = 1.0f;
+    float   invInertia = 0.0f;    // 0 = never rotates
+    float   restitution = 0.25f;
+    float   friction = 0.5f;
+
+    // game properties
+    ShapeType  shape = SHAPE_CIRCLE;
+    ObjectType type = OBJ_BLOCK;
+    Color      color = LIGHTGRAY;
+    bool       active = true;   // if false, skip update/draw
+    bool       alive = true;   // for pigs
+
+    // pig-specific
+    float toughness = 0.0f;
+};
+
+// What game code holds on to instead of a raw array index
+struct BodyHandle {
+    int      id = -1;
+    uint32_t generation = 0;
+    bool IsValid() const { return id >= 0; }
+};
+
+// Collision shape (broadphase + narrowphase). Polygons also fill in
+// radius (bounding circle) and halfExtents (body-space bounding box);
+// chains fill in halfExtents around their points.
+struct BodyShape {
+    ShapeType type = SHAPE_CIRCLE;
+    float     radius = 8.0f;
+    Vector2   halfExtents{ 10.0f, 10.0f };
+    int       polygon = -1;   // index into BodyStore::polygons
+    int       chain = -1;     // index into the world's terrain chains
+};
+
+// Only read when two bodies are in contact
+struct BodyMaterial {
+    float mass = 1.0f;
+    float restitution = 0.25f;
+    float friction = 0.5f;
+};
+
+// Game-side data the physics step never reads in its loops
+struct BodyGameData {
+    ObjectType type = OBJ_BLOCK;
+    Color      color = LIGHTGRAY;
+    bool       alive = true;    // for pigs
+    float      toughness = 0.0f;
+};
+
+// Read-only view of bodies laid out like the store's own arrays (a level
+// file section, another store): BodyStore::AddRange copies them in bulk.
+// shape[i].polygon indexes polygons.
+struct BodyArrays {
+    int                 count = 0;
+    const Vector2*      position = nullptr;
+    const Vector2*      rotation = nullptr;
+    const Vector2*      velocity = nullptr;
+    const float*        angularVelocity = nullptr;
+    const float*        invMass = nullptr;
+    const float*        invInertia = nullptr;
+    const uint8_t*      active = nullptr;
+    const BodyShape*    shape = nullptr;
+    const BodyMaterial* material = nullptr;
+    const BodyGameData* game = nullptr;
+    int                  polygonCount = 0;
+    const ConvexPolygon* polygons = nullptr;
+};
+
+struct BodyStore {
+    // hot: integrator, broadphase, narrowphase
+    std::vector<Vector2>   position;
+    std::vector<Vector2>   rotation;          // unit (cos, sin)
+    std::vector<Vector2>   velocity;
+    std::vector<float>     angularVelocity;
+    std::vector<float>     invMass;
+    std::vector<float>     invInertia;        // 0 = never rotates
+    std::vector<uint8_t>   active;      // if 0, skip update/draw
+    std::vector<uint8_t>   awake;       // active and not asleep: the integrator's mask
+    std::vector<BodyShape> shape;
+
+    // warm / cold
+    std::vector<float>        sleepTime;   // seconds spent below the sleep speed
+    std::vector<BodyMaterial> material;
+    std::vector<BodyGameData> game;
+
+    // shared polygon shapes; entries stay until Clear, even when no body uses them
+    std::vector<ConvexPolygon> polygons;
+
+    BodyHandle Add(const Body& b);
+    int  AddRange(const BodyArrays& src);   // index of the first new body; awake = active
+    int  AddPolygon(const ConvexPolygon& poly);   // reuses the last entry if it is the same shape
+    void Clear();                           // also frees every handle (generations carry on)
+    void Reserve(int n);
+
+    // Deactivates the body and frees its handle; the slot is reclaimed by
+    // the next Compact. Removing twice is harmless.
+    void Remove(BodyHandle h);
+    void RemoveAt(int index);
+    int  RemovedCount() const { return removedCount; }   // waiting for Compact
+
+    // Packs the live bodies down over the removed ones, keeping their order.
+    // Returns false if there was nothing to do; otherwise LastRemap() maps
+    // every old index to its new one (-1 for removed bodies), for anything
+    // outside the store that is indexed by body.
+    bool Compact();
+    const std::vector<int>& LastRemap() const { return remap; }
+    int  CompactionCount() const { return compactions; }
+
+    // Changes whenever a static body (invMass == 0) is added, removed or moved
+    // to another index, so anything built over the static set knows to rebuild
+    uint32_t StaticVersion() const { return staticVersion; }
+
+    // Changes whenever a body is added or removed or bodies move to other
+    // indices (Compact, Clear), so per-index data saved earlier (snapshot
+    // keyframes) knows it no longer lines up
+    uint32_t LayoutVersion() const { return layoutVersion; }
+
+    int  Count() const { return (int)position.size(); }
+    int  IndexOf(BodyHandle h) const;     // -1 if the handle is stale or not from this store
+    BodyHandle HandleOf(int index) const; // invalid for removed bodies
+    bool IsRemoved(int index) const { return handleOfIndex[index] < 0; }
+
+    // Bounding box of body i at its current rotation, as offsets from its position
+    void LocalBounds(int i, Vector2& lo, Vector2& hi) const;
+
+    // gather one body back into the AoS layout (debugging / tools, not hot)
+    Body Get(int index) const;
+
+    // bodies [first, Count()) as a view into this store (with the whole polygon pool)
+    BodyArrays View(int first = 0) const;
+
+private:
+    int AllocateHandle(int index);
+
+    std::vector<int>      indexOfHandle;
+    std::vector<uint32_t> generationOfHandle;
+    std::vector<int>      freeHandles;     // ids to reuse, last freed first
+    std::vector<int>      handleOfIndex;   // -1 once removed
+    std::vector<int>      remap;           // from the last Compact
+    int removedCount = 0;
+    int compactions = 0;
+    uint32_t staticVersion = 0;
+    uint32_t layoutVersion = 0;
+};
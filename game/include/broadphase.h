@@ -0,0 +1,139 @@
+// Broadphase: cheap bounding-box pass that finds which body pairs
+// are worth handing to the narrowphase overlap tests.
+#pragma once
+
+#include "raylib.h"
+#include <cstdint>
+#include <vector>
+
+struct JobSystem;
+
+// ------------------------------------------------------------
+// Shared broadphase types
+
+struct AABB {
+    Vector2 min{ 0.0f, 0.0f };
+    Vector2 max{ 0.0f, 0.0f };
+};
+
+// Inclusive on purpose: touching shapes still reach the narrowphase
+static inline bool AABBOverlaps(const AABB& a, const AABB& b) {
+    return a.min.x <= b.max.x && b.min.x <= a.max.x &&
+           a.min.y <= b.max.y && b.min.y <= a.max.y;
+}
+
+// One proxy per active body, rebuilt every step
+struct BroadphaseProxy {
+    AABB box;
+    int  body = -1;          // index into the body array
+    bool isStatic = false;   // static-static pairs are never reported
+};
+
+// Candidate pair of body indices, always a < b
+struct BodyPair {
+    int a = -1;
+    int b = -1;
+};
+
+static inline bool operator<(const BodyPair& l, const BodyPair& r) {
+    return (l.a != r.a) ? (l.a < r.a) : (l.b < r.b);
+}
+static inline bool operator==(const BodyPair& l, const BodyPair& r) {
+    return l.a == r.a && l.b == r.b;
+}
+
+// Shared by all broadphases: filters static-static and non-overlapping pairs,
+// stores the pair with the lower body index first
+static inline void AddCandidatePair(const BroadphaseProxy& p, const BroadphaseProxy& q, std::vector<BodyPair>& pairs) {
+    if (p.isStatic && q.isStatic) return;
+    if (!AABBOverlaps(p.box, q.box)) return;
+    if (p.body < q.body) pairs.push_back({ p.body, q.body });
+    else                 pairs.push_back({ q.body, p.body });
+}
+
+enum BroadphaseMode {
+    BROADPHASE_BRUTE_FORCE,
+    BROADPHASE_GRID,
+    BROADPHASE_SAP,
+    BROADPHASE_TREE,
+    BROADPHASE_COUNT
+};
+
+const char* BroadphaseModeName(BroadphaseMode mode);
+
+// ------------------------------------------------------------
+// Brute force: every proxy against every other one (reference mode)
+
+void BruteForcePairs(const std::vector<BroadphaseProxy>& proxies, std::vector<BodyPair>& pairs);
+
+// Bodies of the proxies whose box overlaps the region (unsorted)
+void BruteForceQuery(const std::vector<BroadphaseProxy>& proxies, const AABB& region, std::vector<int>& out);
+
+// ------------------------------------------------------------
+// Uniform grid / spatial hash
+// Proxies are binned into every cell their box touches, the bins are
+// sorted by cell key and each bin emits its local pairs. Pairs are sorted
+// and de-duplicated at the end so the output order matches BruteForcePairs.
+
+struct UniformGrid {
+    float cellSize = 64.0f;
+    int   maxCellsPerProxy = 64;   // larger proxies skip the grid
+    int   cellsPerJob = 256;       // cells paired per job when a JobSystem is given
+
+    // jobs may be null; the output is the same either way
+    void FindPairs(const std::vector<BroadphaseProxy>& proxies, std::vector<BodyPair>& pairs,
+        JobSystem* jobs = nullptr);
+
+    // Bodies whose box overlaps the region, looked up in the cells of the
+    // last FindPairs (unsorted, each body once). proxies must be the ones
+    // that call was given.
+    void Query(const AABB& region, const std::vector<BroadphaseProxy>& proxies, std::vector<int>& out) const;
+
+    // scratch buffers, kept between steps to avoid reallocating
+    struct CellEntry {
+        uint64_t cell;
+        int      proxy;
+    };
+    std::vector<CellEntry> entries;
+    std::vector<int>       oversize;   // proxies tested against everything
+    std::vector<int>       cellStart;  // first entry of each occupied cell (+ end sentinel)
+    std::vector<std::vector<BodyPair>> jobPairs;   // per-job output, merged in job order
+};
+
+// ------------------------------------------------------------
+// Sweep and prune
+// Min/max endpoints for both axes stay sorted between steps. Bodies barely
+// move from one step to the next, so re-sorting with insertion sort is close
+// to linear. The sweep runs on whichever axis the bodies are spread out more.
+
+struct SweepAndPrune {
+    void FindPairs(const std::vector<BroadphaseProxy>& proxies, std::vector<BodyPair>& pairs);
+
+    // Bodies whose box overlaps the region, from the x endpoints of the last
+    // FindPairs: a binary search, then a scan back by the widest box at most
+    // (unsorted). proxies must be the ones that call was given.
+    void Query(const AABB& region, const std::vector<BroadphaseProxy>& proxies, std::vector<int>& out) const;
+
+    // Bodies were packed down (BodyStore::Compact): endpoints follow their
+    // bodies to the new indices, removed bodies' endpoints are dropped
+    void Remap(const std::vector<int>& newIndex);
+
+    // stats from the last FindPairs call
+    int candidateCount = 0;   // pairs handed to the narrowphase
+    int sweepOverlaps = 0;    // overlaps on the sweep axis before the other axis check
+    int swapCount = 0;        // insertion sort swaps on both axes
+    int sweepAxis = 0;        // 0 = x, 1 = y
+    float widest = 0.0f;      // largest proxy width along x
+
+    struct Endpoint {
+        float value;
+        int   body;
+        bool  isMin;
+    };
+    std::vector<Endpoint> axis[2];     // persistent sorted lists
+
+    // scratch buffers
+    std::vector<int>     proxyOfBody;  // body index -> proxy index (-1 if gone)
+    std::vector<uint8_t> inList;       // body already has endpoints
+    std::vector<int>     open;         // proxies whose interval is open during the sweep
+};
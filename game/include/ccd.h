@@ -0,0 +1,57 @@
+// Continuous collision detection for fast bodies.
+// A body that moves more than a fraction of its own size in one step could
+// jump over a thin block between two discrete tests. For those bodies the
+// broadphase gets a proxy covering the whole step, and every candidate pair
+// is swept: the body is pulled back to its earliest time of impact (plus a
+// small skin, so the discrete pass still sees the contact and stops it).
+// Terrain segments are swept too, from the front only, so a fast body
+// stops at the ground's surface instead of a whole step inside it.
+#pragma once
+
+#include "body_store.h"
+#include "broadphase.h"
+#include "terrain.h"
+#include <vector>
+
+// Time of impact in [0, 1] of a point moving from p0 by d against the
+// Minkowski sum of a box (center c, half extents half) and a circle of
+// radius radius. False if it misses or already starts inside.
+bool SegmentRoundedBoxTOI(Vector2 p0, Vector2 d, Vector2 c, Vector2 half, float radius, float& t);
+
+// Body a moving from `from` to `to` against body b held at its current
+// position. Any pairing of shapes; polygons count as their bounding box.
+bool SweptTimeOfImpact(const BodyStore& bodies, int a, Vector2 from, Vector2 to, int b, float& t);
+
+// Body a moving from `from` to `to` into the solid side of a terrain
+// segment: when its bounding box (grown by its radius) first reaches the
+// segment's line within the segment's span. False if it moves away, stays
+// in front, or already starts touching (the discrete pass has that one).
+bool SweptSegmentTimeOfImpact(const BodyStore& bodies, int a, Vector2 from, Vector2 to,
+    const TerrainSegment& seg, float& t);
+
+struct ContinuousCollision {
+    bool  enabled = true;
+    float motionFraction = 0.5f;   // swept when a step moves a body more than this much of its own size
+    float skin = 1.0f;             // px moved past the time of impact
+
+    // (1) after integration, before the broadphase: flags the fast bodies
+    // and works out where their step started (explicit Euler: x - v dt)
+    void FindFastBodies(const BodyStore& bodies, float dt);
+    bool IsFast(int i) const { return i < (int)fast.size() && fast[i]; }
+
+    // (2) after the broadphase, before the narrowphase. chainBodies maps
+    // each terrain chain to its body (-1 if it has none), as in
+    // Narrowphase::CollideTerrain.
+    void Sweep(BodyStore& bodies, const std::vector<BodyPair>& pairs, const Terrain& terrain,
+        const std::vector<int>& chainBodies);
+
+    // stats from the last step
+    int fastCount = 0;
+    int hitCount = 0;
+    int segmentsSwept = 0;
+
+    std::vector<uint8_t> fast;
+    std::vector<Vector2> start;   // step start, valid for fast bodies
+    std::vector<float>   toi;     // earliest impact found this step
+    std::vector<int>     fastList;
+};
@@ -0,0 +1,96 @@
+// Contact events: what happened between touching bodies this step, for game
+// code that reacts to hits (pig damage, score, sounds) without reaching
+// into the solver. The stream reads the manifolds around the solve:
+// Prepare notes the momenta before it, Publish adds the impulses it applied
+// and appends the step's events, in manifold order, to a ring buffer.
+//
+// A pair's manifold appearing is CONTACT_BEGIN, every later step it is
+// still there is CONTACT_PERSIST, and the step it goes away CONTACT_END.
+// Manifolds include pairs that are still a little apart (the narrowphase
+// reports those too), so a BEGIN can come with no impulse at all. Pairs
+// that fall asleep are no longer tested, so their contacts END, and BEGIN
+// again when they wake.
+//
+// The ring is written once per step and never blocks: each reader keeps
+// its own cursor and reads whatever was published since. Readers that fall
+// more than the capacity behind lose the oldest events (Read says how
+// many). One step's events always fit; the ring grows if a step ever
+// publishes more than it holds.
+#pragma once
+
+#include "raylib.h"
+#include "body_store.h"
+#include "manifold.h"
+#include <cstdint>
+#include <vector>
+
+enum ContactEventType : uint8_t {
+    CONTACT_BEGIN,
+    CONTACT_PERSIST,
+    CONTACT_END,
+};
+
+struct ContactEvent {
+    ContactEventType type = CONTACT_BEGIN;
+    int        step = 0;
+    BodyHandle a;                // stable; stale once the body is removed
+    BodyHandle b;
+    ObjectType typeA = OBJ_BLOCK;
+    ObjectType typeB = OBJ_BLOCK;
+    int        indexA = -1;      // body indices during the step (until the next Compact)
+    int        indexB = -1;
+    uint32_t   child = 0;        // terrain segment (ContactManifold::child)
+    Vector2    point{ 0.0f, 0.0f };    // middle of the manifold's points
+    Vector2    normal{ 0.0f, 0.0f };   // a -> b
+    float      normalImpulse = 0.0f;   // summed over the points, as solved (0 for END)
+    float      tangentImpulse = 0.0f;  // same, absolute
+    float      relativeMomentum = 0.0f;   // |m_a v_a - m_b v_b| before the solve
+};
+
+const int CONTACT_EVENT_CAPACITY = 1 << 14;   // events kept in the ring at first
+
+struct ContactEventStream {
+    // Before the solve: one pending event per manifold, with the momenta
+    void Prepare(const BodyStore& bodies, const std::vector<ContactManifold>& manifolds);
+
+    // After the solve: impulses from the same manifolds, then one END per
+    // manifold that went away this step; all of it goes into the ring
+    void Publish(const BodyStore& bodies, const std::vector<ContactManifold>& manifolds,
+        const std::vector<ContactManifold>& ended, int step);
+
+    // Forgets the events in the ring; sequence numbers keep counting, so
+    // readers' cursors simply skip ahead
+    void Clear();
+
+    uint64_t Head() const { return head; }   // sequence number of the next event
+    uint64_t Oldest() const { return head - count; }
+
+    // Visits the events from cursor up to the newest and moves cursor past
+    // them. Returns how many had been overwritten before the reader got there.
+    template <typename Visit>
+    int Read(uint64_t& cursor, Visit visit) const {
+        int missed = 0;
+        if (cursor < Oldest()) {
+            missed = (int)(Oldest() - cursor);
+            cursor = Oldest();
+        }
+        for (; cursor < head; ++cursor) visit(ring[(size_t)(cursor & mask)]);
+        return missed;
+    }
+
+    // stats from the last Publish call
+    int published = 0;
+    int begins = 0;
+    int ends = 0;
+
+    std::vector<ContactEvent> ring;   // capacity is a power of two
+    uint64_t mask = 0;
+    uint64_t head = 0;
+    uint64_t count = 0;               // events in the ring
+
+    // scratch
+    std::vector<ContactEvent> pending;
+
+private:
+    void Reserve(size_t capacity);
+};
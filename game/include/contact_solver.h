@@ -0,0 +1,112 @@
+// Sequential-impulse contact solver.
+// Works on the cached manifolds: impulses are accumulated per contact point
+// and clamped on the total (not per iteration), and start from last step's
+// values (warm starting), so stacks settle in a handful of iterations.
+// Impulses act at the contact point, so off-center hits spin bodies that
+// can rotate. The two normal impulses of a face contact are solved
+// together (a 2x2 block), which keeps a box resting on its face from
+// rocking between its corners.
+//
+// Overlap is worked out through the velocities: each point gets a small
+// separating velocity for the penetration past the slop (Baumgarte), so
+// there is no separate position pass. Points the narrowphase reports a
+// little apart get a negative target instead: they may close the gap this
+// step, but not cross it.
+//
+// Constraints are grouped by island. Islands share no dynamic bodies, so
+// each one is solved on its own (in parallel when a JobSystem is given) and
+// the result is the same as solving them one after another.
+//
+// One big island (a large fort) would still end up on a single thread, so
+// islands with at least colorThreshold contacts are graph-colored instead:
+// contacts of one color share no dynamic body, so a color is solved in
+// parallel, 4 rows at a time with SSE2. Colors run in a fixed order, which
+// keeps the result bit-identical on any number of threads.
+#pragma once
+
+#include "body_store.h"
+#include "manifold.h"
+#include "islands.h"
+#include "job_system.h"
+#include <cstdint>
+#include <vector>
+
+// One contact point of a constraint
+struct ContactConstraintPoint {
+    Vector2 rA{ 0.0f, 0.0f };        // contact point relative to each body's center
+    Vector2 rB{ 0.0f, 0.0f };
+    float   normalMass = 0.0f;       // along the normal at the point, angular terms included
+    float   tangentMass = 0.0f;
+    float   velocityBias = 0.0f;     // normal speed to reach: restitution, overlap push-out or gap
+    float   normalImpulse = 0.0f;    // accumulated
+    float   tangentImpulse = 0.0f;
+};
+
+// One manifold prepared for solving (rebuilt every step)
+struct ContactConstraint {
+    int     manifold = -1;   // index into the manifold list (impulses go back there)
+    int     island = -1;     // root body of the island this contact belongs to
+    int     color = 0;       // graph color inside a colored island
+    int     a = -1;
+    int     b = -1;
+    Vector2 normal{ 0.0f, 0.0f };    // a -> b
+    Vector2 tangent{ 0.0f, 0.0f };   // normal rotated +90 deg, fixed so warm starting lines up
+    float   invMassA = 0.0f;
+    float   invMassB = 0.0f;
+    float   invInertiaA = 0.0f;
+    float   invInertiaB = 0.0f;
+    float   friction = 0.0f;
+    int     pointCount = 0;  // may be less than the manifold's (see Prepare)
+    ContactConstraintPoint points[MAX_MANIFOLD_POINTS];
+
+    // two points: K, the normal impulse -> normal velocity matrix, and its inverse
+    float   k11 = 0.0f, k12 = 0.0f, k22 = 0.0f;
+    float   blockMass11 = 0.0f, blockMass12 = 0.0f, blockMass22 = 0.0f;
+};
+
+// Colors 0..MAX_GRAPH_COLORS-1 are conflict free; contacts that don't fit
+// go into one overflow color that is solved serially.
+const int MAX_GRAPH_COLORS = 32;
+
+struct ContactSolver {
+    // settings
+    int   velocityIterations = 8;
+    bool  warmStarting = true;
+    float restitutionThreshold = 30.0f;   // px/s; slower impacts don't bounce (stops resting jitter)
+    float baumgarte = 0.05f;              // share of the overlap (past the slop) pushed out per step
+    float penetrationSlop = 0.5f;         // px of overlap left alone, so resting contacts stay touching
+    float timeStep = 1.0f / 50.0f;        // s; the caller sets this every step
+    bool  graphColoring = true;
+    int   colorThreshold = 128;   // contacts in an island before it gets colored
+    int   rowsPerJob = 64;        // rows of one color per job (multiple of 4)
+
+    // Full solve: prepare, then per island warm start and velocity
+    // iterations; impulses are written back into the manifolds.
+    // jobs may be null (everything runs on the calling thread).
+    void Solve(BodyStore& bodies, std::vector<ContactManifold>& manifolds,
+        const IslandManager& islands, JobSystem* jobs = nullptr);
+
+    void Prepare(const BodyStore& bodies, const std::vector<ContactManifold>& manifolds,
+        const IslandManager& islands);
+    void SolveIsland(BodyStore& bodies, int begin, int end);   // constraints [begin, end)
+    void SolveIslandColored(BodyStore& bodies, int begin, int end, JobSystem* jobs);
+    void StoreImpulses(std::vector<ContactManifold>& manifolds) const;
+
+    std::vector<ContactConstraint> constraints;   // sorted by island, manifold order inside
+
+    struct IslandRange {
+        int begin;
+        int end;
+    };
+    std::vector<IslandRange> islandRanges;
+
+    // stats from the last Solve call
+    int coloredIslands = 0;
+    int colorCount = 0;       // most colors used by one island
+    int overflowRows = 0;     // contacts that landed in the serial overflow color
+
+    // scratch
+    std::vector<uint64_t>    bodyColors;    // per-body bitmask of colors already used
+    std::vector<IslandRange> colorRanges;   // colors of the island being solved
+    std::vector<int>         smallIslands;  // islands solved whole, one job each
+};
@@ -0,0 +1,92 @@
+// Dynamic AABB tree: a bounding volume hierarchy over fattened leaf boxes.
+// Leaves only get reinserted when their body leaves the fat box, everything
+// else is refitted on the way up from a reinsertion.
+#pragma once
+
+#include "broadphase.h"
+#include <vector>
+
+const float TREE_FAT_MARGIN = 6.0f;   // px added around each leaf box
+
+struct DynamicTree {
+    struct Node {
+        AABB box;              // fat box for leaves, union of children otherwise
+        int  parent = -1;      // also "next free" while on the free list
+        int  child1 = -1;
+        int  child2 = -1;
+        int  height = 0;       // 0 = leaf, -1 = free
+        int  body = -1;        // leaf payload
+        bool IsLeaf() const { return child1 == -1; }
+    };
+
+    std::vector<Node> nodes;
+    int root = -1;
+    int freeList = -1;
+
+    // Leaves (proxies)
+    int  CreateProxy(const AABB& box, int body);
+    void DestroyProxy(int proxy);
+    bool MoveProxy(int proxy, const AABB& box);   // true if it had to be reinserted
+
+    const AABB& FatBox(int proxy) const { return nodes[proxy].box; }
+    int  BodyOf(int proxy) const { return nodes[proxy].body; }
+    void SetBody(int proxy, int body) { nodes[proxy].body = body; }
+    void Clear();
+
+    // Calls visit(proxy) for every leaf whose fat box overlaps the query box.
+    // Only reads the tree, so queries may run on several threads at once.
+    template <typename Visit>
+    void Query(const AABB& box, Visit visit) const {
+        if (root == -1) return;
+        int stack[256];   // balancing keeps the height near 1.44 log2(leaves)
+        int top = 0;
+        stack[top++] = root;
+        while (top > 0) {
+            int id = stack[--top];
+            const Node& n = nodes[id];
+            if (!AABBOverlaps(n.box, box)) continue;
+            if (n.IsLeaf()) {
+                visit(id);
+            }
+            else {
+                stack[top++] = n.child1;
+                stack[top++] = n.child2;
+            }
+        }
+    }
+
+    int Height() const { return (root == -1) ? 0 : nodes[root].height; }
+
+private:
+    int  AllocateNode();
+    void FreeNode(int id);
+    void InsertLeaf(int leaf);
+    void RemoveLeaf(int leaf);
+    int  Balance(int a);
+    void Refit(int id);
+};
+
+// ------------------------------------------------------------
+// Broadphase front-end: keeps one tree leaf per body in sync with the
+// per-step proxies and queries the tree for every dynamic body.
+
+struct TreeBroadphase {
+    DynamicTree tree;
+
+    void FindPairs(const std::vector<BroadphaseProxy>& proxies, std::vector<BodyPair>& pairs);
+
+    // body indices whose last-step box overlaps the region (unsorted)
+    void Query(const AABB& region, std::vector<int>& out) const;
+
+    // Bodies were packed down (BodyStore::Compact): leaves follow their
+    // bodies to the new indices, removed bodies lose theirs
+    void Remap(const std::vector<int>& newIndex);
+
+    // stats from the last FindPairs call
+    int reinsertCount = 0;    // leaves that left their fat box
+    int leafCount = 0;
+
+    std::vector<int> leafOfBody;     // body index -> tree leaf (-1 none)
+    std::vector<int> proxyOfBody;    // body index -> proxy index this step
+    std::vector<AABB> tightBox;      // body index -> exact box from the last step
+};
@@ -0,0 +1,18 @@
+// Floating-point mode for the physics translation units.
+// Include FIRST in every .cpp whose float math feeds the simulation state.
+//
+// Lockstep replays need every machine to round the same way. The main
+// hazard is contraction: a compiler may fuse a * b + c into one FMA (one
+// rounding instead of two) whenever the target has FMA, which changes the
+// result depending on compiler, flags and CPU. Contraction is switched off
+// here for the rest of the translation unit; the projects also build with
+// /fp:precise. Explicit SIMD intrinsics are unaffected (none of them are FMA).
+#pragma once
+
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(_MSC_VER)
+#pragma fp_contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
@@ -0,0 +1,49 @@
+// Islands and sleeping.
+// Dynamic bodies that touch are joined with union-find every step; static
+// bodies never join, so the ground doesn't glue the whole level into one
+// island. An island falls asleep once every body in it has been slow for
+// long enough, and wakes as soon as any of its bodies is touched by an
+// awake one. Sleeping bodies are not integrated and the broadphase treats
+// them as static, so a resting fort produces no pairs at all.
+#pragma once
+
+#include "body_store.h"
+#include "manifold.h"
+#include <vector>
+
+struct IslandManager {
+    // settings
+    bool  sleepEnabled = true;
+    float sleepSpeed = 4.0f;      // px/s; slower than this counts as resting
+    float timeToSleep = 0.5f;     // s an island must rest before it sleeps
+
+    // Joins touching dynamic bodies and wakes every island that contains an
+    // awake body. Run after contact generation, before the solver.
+    void Build(BodyStore& bodies, const std::vector<ContactManifold>& manifolds);
+
+    // Advances sleep timers from the solved velocities and puts islands
+    // whose slowest-to-settle body has rested for timeToSleep to sleep.
+    void UpdateSleep(BodyStore& bodies, float dt);
+
+    // Wake-on-impulse: anything that pushes a body from outside the solver
+    // should call this first.
+    static void WakeBody(BodyStore& bodies, int i);
+    static void WakeAll(BodyStore& bodies);
+
+    // stats
+    int islandCount = 0;      // islands with at least one awake body
+    int sleepingCount = 0;    // dynamic bodies asleep after UpdateSleep
+    int wokenCount = 0;       // bodies woken by contact in the last Build
+
+    // Island id (root body index) of body i. Build leaves the forest flat,
+    // so this is a plain read and safe to call from solver jobs.
+    int RootOf(int i) const { return parent[i]; }
+
+    // union-find over body indices (root = smallest index, deterministic)
+    int Find(int i);
+    void Union(int a, int b);
+
+    std::vector<int>     parent;
+    std::vector<uint8_t> islandAwake;   // per root
+    std::vector<float>   islandRest;    // per root: min sleepTime of its bodies
+};
@@ -0,0 +1,63 @@
+// Small work-stealing job system.
+// One job queue per thread; the thread that calls ParallelFor owns queue 0
+// and helps out until its jobs are done. Owners pop from the back of their
+// own queue, idle threads steal from the front of someone else's.
+//
+// ParallelFor cuts [0, count) into fixed chunks of `grain` items, so the
+// chunk boundaries never depend on how many threads there are. Callers that
+// write per-chunk results (index begin / grain) and merge them in chunk
+// order get the same output whatever the thread count.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct JobSystem {
+    typedef std::function<void(int begin, int end)> RangeFn;
+
+    ~JobSystem() { Stop(); }
+
+    // threadCount includes the calling thread; 0 = hardware_concurrency()
+    void Start(int threadCount = 0);
+    void Stop();
+    int  ThreadCount() const { return queues.empty() ? 1 : (int)queues.size(); }
+
+    // Runs fn over [0, count) in chunks of grain and returns when all chunks
+    // are done. Call from one thread at a time (the simulation thread).
+    void ParallelFor(int count, int grain, const RangeFn& fn);
+
+    // stats (reset by ResetStats)
+    std::atomic<int> jobsRun{ 0 };
+    std::atomic<int> jobsStolen{ 0 };
+    void ResetStats() { jobsRun = 0; jobsStolen = 0; }
+
+private:
+    struct Job {
+        const RangeFn*    fn = nullptr;
+        int               begin = 0;
+        int               end = 0;
+        std::atomic<int>* pending = nullptr;
+    };
+    struct Queue {
+        std::mutex      mutex;
+        std::deque<Job> jobs;
+    };
+
+    bool TakeJob(int self, Job& job);
+    void RunJob(const Job& job);
+    void WorkerMain(int self);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread>            workers;
+
+    std::mutex              sleepMutex;
+    std::condition_variable sleepCv;
+    std::atomic<int>        queued{ 0 };
+    bool                    quit = false;
+};
@@ -0,0 +1,61 @@
+// Levels: a text format for authoring and a binary format for loading.
+// Text is compiled into a BodyStore and a Terrain. The binary file (.plvl)
+// holds the compiled bodies as raw sections laid out exactly like
+// BodyStore's arrays, so loading one is a file mapping plus one bulk copy
+// per array, with no per-body parsing. The terrain's BVH is not stored; it
+// is built once per load from the chains' points.
+//
+// Text format, one command per line ('#' starts a comment, y grows down):
+//   world <width>                          widen the world (and its ground) to at least this
+//   set restitution|friction|toughness <v> material of the bodies that follow
+//   set angle <degrees>                    rotation of the blocks and polys that follow
+//   grid <cols> <rows> <dx> <dy>           repeat the next body at (x + col dx, y + row dy)
+//   block <x> <y> <hw> <hh> <mass> [color] rotating box
+//   poly <x> <y> <mass> <px> <py> ... [color]
+//                                          convex hull of 3..8 points around (x, y)
+//   ball <x> <y> <r> <mass> [color]
+//   pig <x> <y> <r> <mass>
+//   wall <x> <y> <hw> <hh> [color]         static axis-aligned box
+//   chain <x> <y> <x> <y> ... [color]      static terrain polyline, solid below
+//                                          when the points run left to right
+// Material defaults to the current sliders. Colors are raylib names
+// (brown, darkgray, ...) or #rrggbb.
+//
+// Binary layout: a header (magic, version, body and polygon counts, world
+// width, then per section its element size and 16-byte aligned offset)
+// followed by the position, rotation, velocity, angularVelocity, invMass,
+// invInertia, active, shape, material and game sections (one element per
+// body), the polygon pool, and the terrain's chain points and chains. A
+// file whose element sizes don't match this build is rejected; compile it
+// again from the text.
+#pragma once
+
+#include "body_store.h"
+#include "terrain.h"
+
+const uint32_t LEVEL_MAGIC = 0x4C564C50;   // "PLVL"
+const uint16_t LEVEL_VERSION = 3;
+
+struct LevelData {
+    float     worldWidth = 0.0f;   // 0 = keep the current width
+    BodyStore bodies;
+    Terrain   terrain;             // chains only, no BVH
+};
+
+// Text -> bodies + terrain; errors go to stderr as name:line
+bool CompileLevelText(const char* text, const char* name, LevelData& out);
+
+// Bodies + terrain chains -> binary level file
+bool SaveLevel(const char* path, float worldWidth, const BodyArrays& src, const Terrain& terrain);
+
+// Text file -> binary level file
+bool CompileLevelFile(const char* textPath, const char* levelPath);
+
+// Replaces the world with the ground plus the level's bodies and terrain
+// (whose BVH is built here). Binary files
+// are memory-mapped and bulk-copied; anything else is compiled as text.
+bool LoadLevel(const char* path);
+bool LoadLevelText(const char* text, const char* name);
+
+// The current world minus the ground, terrain included, as a binary level file
+bool SaveWorldAsLevel(const char* path);
@@ -0,0 +1,65 @@
+// Contact manifolds: the narrowphase contacts of one step, matched against
+// the previous step by body-pair key (plus the terrain segment, for chains)
+// so per-contact solver state survives from frame to frame.
+#pragma once
+
+#include "body_store.h"
+#include "narrowphase.h"
+#include <cstdint>
+#include <vector>
+
+// Stable key for a body pair: built from the bodies' handle ids, so it
+// does not change when bodies move around inside the store. Ids are reused
+// once a body is removed; ManifoldCache::Update ends a removed body's
+// manifolds before they could match its successor's.
+static inline uint64_t PairKey(BodyHandle a, BodyHandle b) {
+    uint32_t lo = (uint32_t)((a.id < b.id) ? a.id : b.id);
+    uint32_t hi = (uint32_t)((a.id < b.id) ? b.id : a.id);
+    return ((uint64_t)lo << 32) | hi;
+}
+
+struct ManifoldPoint {
+    Vector2  position{ 0.0f, 0.0f };   // world
+    float    penetration = 0.0f;
+    uint32_t id = 0;                   // feature pair from the narrowphase
+
+    // solver state carried across frames (matched by id)
+    float    normalImpulse = 0.0f;
+    float    tangentImpulse = 0.0f;
+};
+
+struct ContactManifold {
+    uint64_t key = 0;
+    uint32_t child = 0;         // terrain segment (Contact::child)
+    int      a = -1;            // body indices for the current step
+    int      b = -1;
+    Vector2  normal{ 0.0f, 0.0f };   // a -> b
+    float    penetration = 0.0f;     // deepest point
+    int      pointCount = 0;
+    ManifoldPoint points[MAX_MANIFOLD_POINTS];
+    int      age = 0;           // steps this pair has been touching
+};
+
+struct ManifoldCache {
+    // Matches this step's contacts against the cached manifolds; cached
+    // manifolds of removed bodies always end. Output stays sorted by key,
+    // then child.
+    void Update(const BodyStore& bodies, const std::vector<Contact>& contacts);
+    void Clear();
+
+    // Bodies were packed down (BodyStore::Compact): manifolds still held
+    // for removed bodies are dropped, the rest follow their bodies
+    void Remap(const std::vector<int>& newIndex);
+
+    std::vector<ContactManifold> manifolds;
+    std::vector<ContactManifold> ended;   // last Update: the ones that went away (contact events)
+
+    // stats from the last Update call
+    int created = 0;
+    int kept = 0;
+    int removed = 0;
+
+    // scratch
+    std::vector<ContactManifold> incoming;
+    std::vector<ContactManifold> previous;
+};
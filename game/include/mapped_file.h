@@ -0,0 +1,23 @@
+// Read-only memory-mapped file (Win32 file mapping / POSIX mmap).
+// Kept in its own translation unit so <windows.h> never meets raylib.h.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct MappedFile {
+    const uint8_t* data = nullptr;
+    size_t         size = 0;
+
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const char* path);   // false for missing or empty files
+    void Close();
+
+private:
+    void* file = nullptr;      // Win32 file + mapping handles (unused on POSIX)
+    void* mapping = nullptr;
+};
@@ -0,0 +1,100 @@
+// Narrowphase: exact shape tests for the broadphase candidate pairs.
+// Produces a compact contact buffer that the solver consumes afterwards.
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "body_store.h"
+#include "broadphase.h"
+#include "terrain.h"
+#include <vector>
+
+const int MAX_MANIFOLD_POINTS = 2;
+
+struct ContactPoint {
+    Vector2  position{ 0.0f, 0.0f };   // world, halfway between the two surfaces
+    float    penetration = 0.0f;
+    uint32_t id = 0;                   // feature pair, so the point can be matched next step
+};
+
+// One touching pair, normal points from a to b. Curved contacts have one
+// point; two polygon faces resting on each other have two. Tests with a
+// polygon also report points that are still a little apart (penetration
+// below zero), so resting contacts exist before anything overlaps.
+struct Contact {
+    int     a = -1;
+    int     b = -1;
+    uint32_t child = 0;                // terrain: the segment (a chain touches a body once per segment)
+    float   penetration = 0.0f;        // deepest point
+    Vector2 normal{ 0.0f, 0.0f };
+    int     pointCount = 0;
+    ContactPoint points[MAX_MANIFOLD_POINTS];
+};
+
+static inline Vector2 SafeNormalize(const Vector2& v, const Vector2& fallback = { 1.0f, 0.0f }) {
+    float len = Vector2Length(v);
+    return (len > 1e-6f) ? Vector2Scale(v, 1.0f / len) : fallback;
+}
+
+// ------------------------------------------------------------
+// Single-pair overlap tests (return penetration + contact normal)
+
+bool CircleCircleOverlap(Vector2 posA, float radiusA, Vector2 posB, float radiusB,
+    float& penetration, Vector2& normal);
+bool AABBAABBOverlap(Vector2 posA, Vector2 halfA, Vector2 posB, Vector2 halfB,
+    float& penetration, Vector2& normal);
+bool CircleAABBOverlap(Vector2 circlePos, float radius, Vector2 boxPos, Vector2 boxHalf,
+    float& penetration, Vector2& normal);
+
+// Polygon tests. Polygons (and AABBs) are separated on their face normals
+// (SAT); the face that separates least becomes the reference face and the
+// most opposed face of the other shape is clipped against its sides, which
+// leaves up to two points. Normals come from the precomputed body-space
+// ones, rotated; no trigonometry.
+bool PolygonPolygonCollide(const ConvexPolygon& polyA, Vector2 posA, Vector2 rotA,
+    const ConvexPolygon& polyB, Vector2 posB, Vector2 rotB, Contact& out);
+bool CirclePolygonCollide(Vector2 circlePos, float radius,
+    const ConvexPolygon& poly, Vector2 polyPos, Vector2 polyRot, Contact& out);
+
+// Terrain segments (terrain.h) are one-sided and always the reference
+// face; the normal is the segment's, or from an end point to a circle's
+// center. Bodies behind a segment are pushed out along its normal.
+bool SegmentPolygonCollide(const TerrainSegment& seg,
+    const ConvexPolygon& poly, Vector2 polyPos, Vector2 polyRot, Contact& out);
+bool SegmentCircleCollide(const TerrainSegment& seg, Vector2 circlePos, float radius, Contact& out);
+
+// Shape dispatch for one body pair; normal always points a -> b.
+// Fills in normal, penetration and the contact points (not a / b).
+bool BodiesOverlap(const BodyStore& bodies, int a, int b, Contact& out);
+
+// ------------------------------------------------------------
+// Batched narrowphase
+// Pairs are split by shape combination, then tested 4 at a time with SSE2
+// when GetSimdLevel() allows it (scalar otherwise). Pairs with a polygon
+// always take the scalar SAT path. Results land in per-pair slots and are
+// compacted in pair order, so the contact buffer is the same at every SIMD
+// level and keeps the broadphase ordering.
+
+struct Narrowphase {
+    void Collide(const BodyStore& bodies, const std::vector<BodyPair>& pairs, std::vector<Contact>& contacts);
+
+    // Dynamic, awake proxies against the terrain's segment BVH; contacts are
+    // appended with the chain's body (chainBodies[chain]) as a.
+    void CollideTerrain(const BodyStore& bodies, const Terrain& terrain, const std::vector<int>& chainBodies,
+        const std::vector<BroadphaseProxy>& proxies, std::vector<Contact>& contacts);
+
+    // stats from the last Collide / CollideTerrain calls
+    int pairsTested = 0;
+    int simdBatches = 0;     // 4-pair batches run through SIMD lanes
+    int contactCount = 0;
+    int segmentsTested = 0;
+    int terrainContactCount = 0;
+
+    // scratch buffers, kept between steps
+    std::vector<int>     circleCircle;   // pair indices per shape combination
+    std::vector<int>     circleBox;
+    std::vector<int>     boxBox;
+    std::vector<int>     polygonPairs;
+    std::vector<uint8_t> hit;            // per pair
+    std::vector<Contact> result;         // per pair
+};
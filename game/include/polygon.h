@@ -0,0 +1,49 @@
+// Convex polygons for rotating bodies.
+// A polygon is built once, in body space, with its centroid at the origin
+// and its edge normals worked out up front. Bodies carry their orientation
+// as a unit (cos, sin) pair instead of an angle, so placing a polygon in
+// the world is a rotate and a translate per vertex and nothing in the
+// physics step calls sinf / cosf / atan2f.
+#pragma once
+
+#include "raylib.h"
+
+const int MAX_POLYGON_VERTICES = 8;
+
+struct ConvexPolygon {
+    int     count = 0;
+    Vector2 vertices[MAX_POLYGON_VERTICES];   // body space, centroid at the origin, positive winding
+    Vector2 normals[MAX_POLYGON_VERTICES];    // outward unit normal of edge i -> i + 1
+    float   radius = 0.0f;                    // farthest vertex from the centroid
+};
+
+// ------------------------------------------------------------
+// Rotations as unit complex numbers (cos, sin)
+
+static inline Vector2 Rotate(Vector2 rot, Vector2 v) {
+    return { rot.x * v.x - rot.y * v.y, rot.y * v.x + rot.x * v.y };
+}
+
+static inline Vector2 InvRotate(Vector2 rot, Vector2 v) {
+    return { rot.x * v.x + rot.y * v.y, rot.x * v.y - rot.y * v.x };
+}
+
+// Setup and drawing only; the step works on the (cos, sin) pair
+Vector2 RotationFromAngle(float radians);
+float   AngleOf(Vector2 rot);
+
+// ------------------------------------------------------------
+// Building
+
+// Convex hull of up to MAX_POLYGON_VERTICES points. The hull is moved so
+// its centroid sits at the origin; centroid (if given) receives where that
+// was in the points' frame. False if the points span no area.
+bool BuildPolygon(const Vector2* points, int count, ConvexPolygon& out, Vector2* centroid = nullptr);
+
+// Box centered on the origin
+ConvexPolygon MakeBoxPolygon(Vector2 halfExtents);
+
+// Moment of inertia about the centroid for this mass, uniform density
+float PolygonInertia(const ConvexPolygon& poly, float mass);
+
+bool SamePolygon(const ConvexPolygon& a, const ConvexPolygon& b);
@@ -0,0 +1,88 @@
+// Lightweight hot-path profiler.
+// PROFILE_SCOPE(PHASE_X) times the rest of the enclosing block with a
+// nanosecond clock. Times are summed per phase over a frame; EndFrame()
+// pushes the totals into a ring buffer per phase (for the averages, p99 and
+// the overlay graph). While a trace is being captured every scope is also
+// kept as a Chrome trace event (chrome://tracing, Perfetto).
+//
+// Scopes are meant for the simulation thread only; jobs running on
+// worker threads are covered by the scope that waits for them.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+enum ProfilePhase {
+    PHASE_INTEGRATE,
+    PHASE_BROADPHASE,
+    PHASE_NARROWPHASE,
+    PHASE_SOLVE,
+    PHASE_SLEEP,       // island build, damping, sleep timers
+    PHASE_DRAW,
+    PHASE_COUNT
+};
+
+const char* ProfilePhaseName(ProfilePhase phase);
+
+// Monotonic clock in nanoseconds
+int64_t ProfileNowNs();
+
+struct Profiler {
+    static constexpr int HISTORY = 240;   // frames kept per phase
+
+    bool enabled = true;
+
+    void Record(ProfilePhase phase, int64_t startNs, int64_t endNs);
+    void EndFrame();   // closes the frame: totals go into the ring buffers
+
+    // Over the frames in the ring buffer, in ns
+    double Last(ProfilePhase phase) const;
+    double Average(ProfilePhase phase) const;
+    double Percentile(ProfilePhase phase, double p) const;   // p in [0, 1]
+    int    Samples() const { return count; }
+    double Sample(ProfilePhase phase, int age) const;        // age 0 = last frame
+
+    // Trace capture (Chrome trace-event JSON)
+    void StartTrace();
+    bool StopTrace(const char* path);   // writes the file; false if it can't be opened
+    bool Tracing() const { return tracing; }
+    int  TraceEventCount() const { return (int)events.size(); }
+
+    int maxTraceEvents = 1 << 20;   // events beyond this are dropped (counted)
+    int droppedEvents = 0;
+
+private:
+    struct TraceEvent {
+        int64_t start;
+        int64_t duration;
+        int     phase;   // PHASE_COUNT marks a frame
+    };
+
+    int64_t frameTotal[PHASE_COUNT] = {};
+    double  history[PHASE_COUNT][HISTORY] = {};
+    int     head = 0;    // next slot to write
+    int     count = 0;   // filled slots
+
+    bool    tracing = false;
+    int64_t traceStart = 0;
+    int64_t frameStart = 0;
+    std::vector<TraceEvent> events;
+};
+
+extern Profiler profiler;
+
+// Times the rest of the enclosing block into one phase
+struct ScopedTimer {
+    explicit ScopedTimer(ProfilePhase phase) : phase(phase), start(ProfileNowNs()) {}
+    ~ScopedTimer() { profiler.Record(phase, start, ProfileNowNs()); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ProfilePhase phase;
+    int64_t      start;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(phase) ScopedTimer PROFILE_CONCAT(profileScope_, __LINE__)(phase)
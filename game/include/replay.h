@@ -0,0 +1,49 @@
+// Lockstep replays.
+// A run is reproduced from its starting scene plus a list of events, each
+// keyed by the step it applies before: bird launches, explosions and
+// changes to the tunables (GUI sliders and toggles). In deterministic mode the simulation
+// records these events as they happen and hashes the world after every
+// step; replaying the events has to give the same hash at every step, on
+// any machine, or the first differing step shows where the runs split.
+#pragma once
+
+#include "raylib.h"
+#include <cstdint>
+#include <vector>
+
+enum ReplayEventKind {
+    REPLAY_LAUNCH,
+    REPLAY_SET,
+    REPLAY_EXPLODE
+};
+
+struct ReplayEvent {
+    uint32_t        step = 0;
+    ReplayEventKind kind = REPLAY_LAUNCH;
+    Vector2         velocity{ 0.0f, 0.0f };   // launch
+    int             birdType = 0;             // launch: 0 = circle, 1 = square
+    int             tunable = -1;             // set: index into the tunable table
+    float           value = 0.0f;             // set
+    Vector2         position{ 0.0f, 0.0f };   // explode: center
+    float           radius = 0.0f;            // explode
+    float           strength = 0.0f;          // explode
+};
+
+// Settings that change the outcome of a run
+int         TunableCount();
+const char* TunableName(int index);
+int         FindTunable(const char* name);          // -1 if unknown
+float       GetTunable(int index);
+void        SetTunable(int index, float value);     // "hz" also updates dt
+
+// Text format, one event per line ('#' starts a comment):
+//   <step> <vx> <vy> [circle|square]
+//   <step> set <name> <value>
+//   <step> explode <x> <y> <radius> <strength>
+// Floats are written with 9 significant digits, so they read back exactly.
+bool LoadReplayScript(const char* path, std::vector<ReplayEvent>& out);   // errors go to stderr
+bool SaveReplayScript(const char* path, const std::vector<ReplayEvent>& events);
+
+// Hash logs: one "<step> <hash>" line per step, hash in hex
+bool SaveHashLog(const char* path, const std::vector<uint64_t>& hashes);
+bool LoadHashLog(const char* path, std::vector<uint64_t>& out);
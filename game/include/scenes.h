@@ -0,0 +1,21 @@
+// Synthetic scenes for benchmarks and the headless runner.
+// Built the same way as BuildWorld (ClearWorld for the ground, then Make* +
+// bodies.Add), at any size from a handful to 100k bodies. The world is
+// widened so the ground spans the whole layout, and the layout comes from a
+// fixed seed, so a scene of a given size is identical on every run.
+#pragma once
+
+enum SceneKind {
+    SCENE_PYRAMIDS,   // rows of box pyramids (20-block base)
+    SCENE_BALL_PIT,   // circles dropped into walled pits
+    SCENE_FORTS,      // BuildWorld-style forts of varying size, pigs included
+    SCENE_DEBRIS,     // sparse blocks and circles scattered over a large area
+    SCENE_HILLS,      // blocks and circles dropped on a long terrain chain
+    SCENE_COUNT
+};
+
+const char* SceneName(SceneKind kind);                  // short lowercase name ("pyramids", ...)
+bool        ParseScene(const char* name, SceneKind& out);
+
+// Replaces the world with bodyCount dynamic bodies (statics not counted)
+void BuildScene(SceneKind kind, int bodyCount);
@@ -0,0 +1,115 @@
+// Simulation core: world state, world setup and the fixed physics step.
+// Nothing in here opens a window or draws, so the same code runs inside the
+// raylib game (main.cpp) and in the headless batch runner.
+#pragma once
+
+#include "raylib.h"
+#include "body_store.h"
+#include "broadphase.h"
+#include "dynamic_tree.h"
+#include "narrowphase.h"
+#include "manifold.h"
+#include "contact_events.h"
+#include "contact_solver.h"
+#include "islands.h"
+#include "job_system.h"
+#include "ccd.h"
+#include "terrain.h"
+#include "static_bvh.h"
+#include "replay.h"
+#include <cstdint>
+#include <vector>
+
+// ------------------------------------------------------------
+// Step + tunables (the game exposes these as GUI sliders)
+
+extern float timeElapsed;          // simulated time
+extern float dt;                   // fixed physics step (1 / physicsHz)
+
+extern float gravityAcc;           // px/s^2 (down)
+extern float globalRestitution;    // bounciness (0..1), applied to new bodies
+extern float globalFrictionCoeff;  // dynamic friction (0..1), applied to new bodies
+extern float pigToughness;         // how hard pigs are to kill
+extern float solverIterations;     // velocity iterations per step
+extern float physicsHz;            // physics steps per second
+
+// ------------------------------------------------------------
+// World
+
+extern BodyStore  bodies;
+extern BodyHandle lastBird;        // most recently launched bird
+extern Vector2    slingAnchor;     // where birds are launched from
+extern float      groundY;
+extern float      worldWidth;      // ground spans this (the window width in the game)
+extern Terrain    terrain;         // static chains; each has a SHAPE_CHAIN body (MakeChain)
+
+// Pipeline state (kept global so the game can show stats)
+extern BroadphaseMode broadphaseMode;
+extern UniformGrid    broadphaseGrid;
+extern SweepAndPrune  broadphaseSap;
+extern TreeBroadphase broadphaseTree;
+extern StaticBodyIndex staticIndex;   // static bodies, out of the proxies (static_bvh.h)
+extern std::vector<BroadphaseProxy> broadphaseProxies;
+extern std::vector<BodyPair>        candidatePairs;
+
+extern Narrowphase          narrowphase;
+extern std::vector<Contact> contacts;
+extern ManifoldCache        manifoldCache;
+extern ContactEventStream   contactEvents;   // read after UpdatePhysics (each reader keeps a cursor)
+extern ContactSolver        contactSolver;
+extern IslandManager        islands;
+extern JobSystem            jobs;
+extern ContinuousCollision  ccd;
+extern bool                 ccdEnabled;
+
+// ------------------------------------------------------------
+// Lockstep (see replay.h)
+
+extern bool     deterministicMode;          // record events + hash the world every step
+extern uint32_t stepIndex;                  // steps since the world was (re)built
+extern std::vector<uint64_t>    stepHashes;     // WorldHash() after each step, deterministic mode only
+extern std::vector<ReplayEvent> replayEvents;   // launches + tunable changes, deterministic mode only
+
+// ------------------------------------------------------------
+// Setup
+
+Body MakeCircle(ObjectType type, Vector2 pos, float radius, float mass, Color color);
+Body MakeAABB(ObjectType type, Vector2 pos, Vector2 halfExtents, float mass, Color color);   // never rotates
+Body MakeBox(ObjectType type, Vector2 pos, Vector2 halfExtents, float mass, Color color, float angle = 0.0f);
+// Convex hull of up to MAX_POLYGON_VERTICES points around pos (unrotated);
+// the body sits at the hull's centroid. polygon.count is 0 if the points
+// span no area.
+Body MakePolygon(ObjectType type, Vector2 pos, const Vector2* points, int count, float mass, Color color,
+    float angle = 0.0f);
+// Static body for chain (from t.AddChain); add it to the store alongside
+// the chain, and Build the terrain once the last chain is in
+Body MakeChain(const Terrain& t, int chain, Color color);
+
+void ClearWorld();   // ground only (terrain cleared)
+
+// The bodies were replaced between steps (ClearWorld, RestoreSnapshot):
+// region queries stop trusting the last step's broadphase until the next step
+void InvalidateBroadphase();
+void BuildWorld();   // ground + the default fort
+void SpawnBird(const Vector2& velocity, int birdType);   // 0 = circle, 1 = square (rotating box)
+
+// Explosion: pushes every dynamic body within radius of center away from
+// it, with an impulse of strength at the center fading to 0 at the edge
+// (measured to the body's box). Queued; everything queued before a step
+// is applied together at its start, so dozens in one step cost one batch.
+void ApplyRadialImpulse(Vector2 center, float radius, float strength);
+
+// ------------------------------------------------------------
+// Step
+
+void UpdatePhysics();   // one fixed step of dt (timed per phase into the profiler)
+
+// Active bodies whose box overlaps the rectangle (as of the last step), terrain chains left out.
+// Looked up in the current broadphase and the static index; sorted by index.
+void QueryAABB(Rectangle region, std::vector<int>& out);
+// Same, for bodies whose current box comes within radius of center
+void QueryCircle(Vector2 center, float radius, std::vector<int>& out);
+
+// 64-bit hash of the body count and every body's position, rotation,
+// linear and angular velocity and active / awake / alive flags (bit patterns, so -0.0f and 0.0f differ)
+uint64_t WorldHash();
@@ -0,0 +1,108 @@
+// World snapshots for rewinding.
+// A snapshot is the body store packed into a compact, versioned binary
+// blob. A keyframe carries every body; a delta carries only the state that
+// moves (position, angle, velocities, sleep timer, flags), as the difference from a
+// keyframe with the same bodies at the same indices. Moving state is quantized to fixed point
+// and written as zigzag varints, so a body that hasn't moved since the
+// keyframe costs one byte in a delta.
+//
+// Blob layout (little endian):
+//   header   magic "PSNP", version, kind, body count, step, time, last bird (index),
+//            body layout (BodyStore::LayoutVersion when it was written)
+//   key      polygon pool (count, then per polygon its vertex count,
+//            vertices, normals and radius), then per body: shape, type,
+//            flags, color, polygon (or terrain chain) index, 9 floats
+//            (geometry, material, inverse inertia, toughness), then its
+//            quantized state
+//   delta    per body: flags (bit 7 = state changed), then if changed
+//            its quantized state minus the keyframe's
+//
+// Quantizing means a restore is close to, not bit-identical with, the
+// recorded world: fine for scrubbing back, not for lockstep replays.
+// Terrain never moves, so it is not in the blob: chain bodies keep their
+// chain index and are restored against the world's current terrain.
+#pragma once
+
+#include "body_store.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+const uint32_t SNAPSHOT_MAGIC = 0x504E5350;   // "PSNP"
+const uint16_t SNAPSHOT_VERSION = 5;
+
+enum SnapshotKind {
+    SNAPSHOT_KEY,
+    SNAPSHOT_DELTA
+};
+
+// Fixed-point steps of the quantized state
+const float SNAPSHOT_POSITION_SCALE = 256.0f;   // 1/256 px
+const float SNAPSHOT_VELOCITY_SCALE = 64.0f;    // 1/64 px/s
+const float SNAPSHOT_ANGLE_SCALE = 10000.0f;    // 0.1 mrad
+const float SNAPSHOT_SPIN_SCALE = 1000.0f;      // mrad/s
+const float SNAPSHOT_SLEEP_SCALE = 1000.0f;     // ms
+
+// Quantized state per body: x, y, angle, vx, vy, angular velocity, sleep timer
+const int SNAPSHOT_LANES = 7;
+void QuantizeBodies(const BodyStore& bodies, std::vector<int32_t>& out);
+
+// What a keyframe leaves behind for its deltas
+struct SnapshotKeyState {
+    std::vector<int32_t> state;   // quantized, SNAPSHOT_LANES per body
+    uint32_t layout = 0;          // BodyStore::LayoutVersion at the keyframe
+};
+
+// Keyframe of the current world. keyState (if given) receives the
+// quantized state that later deltas are taken against.
+void SaveSnapshot(std::vector<uint8_t>& out, SnapshotKeyState* keyState = nullptr);
+
+// Delta of the current world against a keyframe's quantized state.
+// False if any body has been added, removed or moved to another index
+// since the keyframe: a delta only works index by index.
+bool SaveDeltaSnapshot(const SnapshotKeyState& keyState, std::vector<uint8_t>& out);
+
+// Rebuilds the world (bodies, step counter, clock, last bird) from a
+// keyframe, or a keyframe plus one of its deltas. Warm-start data is
+// dropped, as after ClearWorld. False, with the world untouched, if a
+// blob is malformed, from another version, or doesn't match the keyframe.
+bool RestoreSnapshot(const std::vector<uint8_t>& key, const std::vector<uint8_t>* delta = nullptr);
+
+// The last few seconds of steps, one snapshot per step, in a ring buffer.
+// A keyframe is written every keyframeInterval steps and whenever bodies
+// are added, removed or compacted; the steps in between are deltas against it. When a
+// keyframe falls out of the window its deltas go with it. Slots keep their
+// buffers, so once the ring is full recording doesn't allocate.
+struct SnapshotHistory {
+    int keyframeInterval = 50;
+
+    void Reset(int capacity);   // drops everything; capacity in steps
+    void Record();              // snapshot of the current world, after each step
+
+    // Rewinds the world by `steps` recorded steps (clamped to the oldest
+    // one) and forgets everything newer. Returns the steps actually rewound.
+    int Rewind(int steps);
+
+    int    Count() const { return count; }
+    int    Capacity() const { return (int)ring.size(); }
+    size_t Bytes() const;       // blob bytes currently held
+
+    // stats
+    int keyCount = 0;           // keyframes in the ring
+
+private:
+    struct Entry {
+        std::vector<uint8_t> blob;
+        int  key = -1;           // slot of the keyframe this delta is against (own slot for keyframes)
+    };
+
+    int  Slot(int age) const { return (head + (int)ring.size() - 1 - age) % (int)ring.size(); }
+    void DropOldest();
+
+    std::vector<Entry>   ring;
+    int                  head = 0;      // next slot to write
+    int                  count = 0;
+    int                  newestKey = -1;
+    int                  sinceKey = 0;  // deltas written since newestKey
+    SnapshotKeyState     keyState;      // of newestKey
+};
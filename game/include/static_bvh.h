@@ -0,0 +1,87 @@
+// Immutable bounding volume hierarchy over a fixed set of boxes, for
+// geometry that never moves: terrain segments and static bodies. It is
+// built once, top down, splitting at the median, and never refitted or
+// rebalanced, so it can be a flat array of nodes in depth-first order.
+// Queries only read it, so any number of threads can run them at once.
+//
+// StaticBodyIndex puts it to work as the broadphase's static partition:
+// static bodies (invMass == 0) are no proxies of their own; each awake
+// dynamic proxy queries the index instead, so static-static pairs are
+// never even looked at.
+#pragma once
+
+#include "broadphase.h"
+#include <cstdint>
+#include <vector>
+
+const int STATIC_BVH_LEAF_ITEMS = 4;   // most items in one leaf
+
+struct StaticBVH {
+    struct Node {
+        AABB box;
+        int  first = 0;   // leaf: first slot; inner node: right child (the left one is next)
+        int  count = 0;   // slots in a leaf, 0 for inner nodes
+    };
+
+    std::vector<Node> nodes;   // empty until Build
+    std::vector<int>  items;   // per slot, in leaf order: the caller's item index
+    std::vector<AABB> boxes;   // per slot, the item's box
+
+    void Build(const AABB* itemBoxes, int count);   // item i has box itemBoxes[i]
+    void Clear();
+    bool Empty() const { return nodes.empty(); }
+
+    // Calls visit(item) for every item whose box overlaps the query box
+    template <typename Visit>
+    void Query(const AABB& box, Visit visit) const {
+        if (nodes.empty()) return;
+        int stack[64];   // median splits keep the depth near log2(items / leaf)
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            int id = stack[--top];
+            const Node& n = nodes[id];
+            if (!AABBOverlaps(n.box, box)) continue;
+            if (n.count > 0) {
+                for (int s = n.first; s < n.first + n.count; ++s) {
+                    if (AABBOverlaps(boxes[s], box)) visit(items[s]);
+                }
+            }
+            else {
+                stack[top++] = n.first;
+                stack[top++] = id + 1;
+            }
+        }
+    }
+
+private:
+    int BuildNode(const AABB* itemBoxes, int first, int count);
+};
+
+// ------------------------------------------------------------
+// Static partition of the broadphase
+
+struct StaticBodyIndex {
+    // Static bodies and their boxes (parallel arrays); builds the tree
+    void Build(const std::vector<int>& bodies, const std::vector<AABB>& bodyBoxes);
+    void Clear();
+
+    // Awake dynamic proxies (isStatic false) against the static bodies.
+    // pairs must be sorted; the new pairs are merged in, so it stays sorted.
+    void FindPairs(const std::vector<BroadphaseProxy>& proxies, std::vector<BodyPair>& pairs);
+
+    // Static bodies whose box overlaps the region (unsorted)
+    void Query(const AABB& region, std::vector<int>& out) const;
+
+    int BodyCount() const { return (int)body.size(); }
+
+    // stats from the last FindPairs call
+    int pairCount = 0;
+
+    StaticBVH        tree;
+    std::vector<int> body;   // tree item -> body index
+
+    // scratch
+    std::vector<BodyPair> staticPairs;
+    std::vector<BodyPair> merged;
+};
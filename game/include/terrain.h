@@ -0,0 +1,65 @@
+// Static terrain: chains of line segments (hills, slopes, ledges), far too
+// many to be bodies of their own in the broadphase. A chain is a polyline;
+// its segments are one-sided, with solid ground behind their normal (the
+// direction v1 -> v2 turned -90 deg), so points listed left to right make
+// ground that is solid below. Anything that sinks into a segment is pushed
+// back out along its normal, up to TERRAIN_DEPTH behind it.
+//
+// All segments go into one StaticBVH (static_bvh.h), built once when the
+// level is loaded and never changed afterwards. Dynamic bodies query it
+// with their own box and only test the segments that come back.
+//
+// In the body store a chain is one static body of shape SHAPE_CHAIN (see
+// MakeChain): it carries the chain's material and color and is side a of
+// its contacts, but never becomes a broadphase proxy.
+#pragma once
+
+#include "raylib.h"
+#include "broadphase.h"
+#include "static_bvh.h"
+#include <vector>
+
+const float TERRAIN_DEPTH = 40.0f;   // px of solid ground behind each segment
+
+// Round shapes only touch an end point where no neighbouring face can: at
+// the ends of the chain and where it bends down (convex), and there only
+// outside the next face. A flat or concave joint is covered by the faces,
+// so nothing rolling across it gets bumped by the next segment's start.
+struct TerrainSegment {
+    Vector2 v1{ 0.0f, 0.0f };
+    Vector2 v2{ 0.0f, 0.0f };
+    Vector2 normal{ 0.0f, 0.0f };   // out of the ground
+    Vector2 next{ 0.0f, 0.0f };     // unit direction of the next segment, zero at the chain's end
+    bool    startCorner = false;    // v1 is the chain's first point
+    bool    endCorner = false;      // v2 is the chain's last point, or a convex bend
+    AABB    box;                    // segment plus TERRAIN_DEPTH behind it
+    int     chain = -1;
+};
+
+struct TerrainChain {
+    int  first = 0;   // into Terrain::points
+    int  count = 0;
+    AABB box;         // of the points
+};
+
+struct Terrain {
+    std::vector<Vector2>        points;     // every chain's polyline, as given
+    std::vector<TerrainChain>   chains;
+    std::vector<TerrainSegment> segments;   // in chain order
+    StaticBVH                   bvh;        // over the segments' boxes; empty until Build
+
+    // Chain through count points (at least 2); returns its index, or -1.
+    // Zero-length segments are dropped. Call Build after the last chain.
+    int  AddChain(const Vector2* chainPoints, int count);
+    void Build();
+    void Clear();
+
+    int  ChainCount() const { return (int)chains.size(); }
+    bool IsBuilt() const { return !bvh.Empty() || segments.empty(); }
+
+    // Calls visit(segment) for every segment whose box overlaps the query box
+    template <typename Visit>
+    void Query(const AABB& box, Visit visit) const {
+        bvh.Query(box, visit);
+    }
+};
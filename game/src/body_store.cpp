@@ -0,0 +1,294 @@
+#include "fp_mode.h"
+#include "body_store.h"
+
+#include <algorithm>
+
+using namespace std;
+
+BodyHandle BodyStore::Add(const Body& b) {
+    int index = Count();
+    const bool rotates = (b.shape != SHAPE_AABB && b.shape != SHAPE_CHAIN);
+
+    position.push_back(b.position);
+    rotation.push_back(rotates ? RotationFromAngle(b.angle) : Vector2{ 1.0f, 0.0f });
+    velocity.push_back(b.velocity);
+    angularVelocity.push_back(rotates ? b.angularVelocity : 0.0f);
+    invMass.push_back(b.invMass);
+    invInertia.push_back(rotates ? b.invInertia : 0.0f);
+    active.push_back(b.active ? 1 : 0);
+    awake.push_back(b.active ? 1 : 0);
+    sleepTime.push_back(0.0f);
+
+    BodyShape s;
+    s.type = b.shape;
+    s.radius = b.radius;
+    s.halfExtents = b.halfExtents;
+    if (b.shape == SHAPE_POLYGON) s.polygon = AddPolygon(b.polygon);
+    if (b.shape == SHAPE_CHAIN) s.chain = b.chain;
+    shape.push_back(s);
+
+    BodyMaterial m;
+    m.mass = b.mass;
+    m.restitution = b.restitution;
+    m.friction = b.friction;
+    material.push_back(m);
+
+    BodyGameData g;
+    g.type = b.type;
+    g.color = b.color;
+    g.alive = b.alive;
+    g.toughness = b.toughness;
+    game.push_back(g);
+
+    handleOfIndex.push_back(AllocateHandle(index));
+    if (b.invMass == 0.0f) ++staticVersion;
+    ++layoutVersion;
+    return HandleOf(index);
+}
+
+int BodyStore::AddRange(const BodyArrays& src) {
+    const int first = Count();
+    const int n = src.count;
+
+    position.insert(position.end(), src.position, src.position + n);
+    rotation.insert(rotation.end(), src.rotation, src.rotation + n);
+    velocity.insert(velocity.end(), src.velocity, src.velocity + n);
+    angularVelocity.insert(angularVelocity.end(), src.angularVelocity, src.angularVelocity + n);
+    invMass.insert(invMass.end(), src.invMass, src.invMass + n);
+    invInertia.insert(invInertia.end(), src.invInertia, src.invInertia + n);
+    active.insert(active.end(), src.active, src.active + n);
+    awake.insert(awake.end(), src.active, src.active + n);
+    shape.insert(shape.end(), src.shape, src.shape + n);
+    sleepTime.resize(first + n, 0.0f);
+    material.insert(material.end(), src.material, src.material + n);
+    game.insert(game.end(), src.game, src.game + n);
+    if (find(src.invMass, src.invMass + n, 0.0f) != src.invMass + n) ++staticVersion;
+
+    // the source's polygons go on the end of the pool
+    const int polygonBase = (int)polygons.size();
+    polygons.insert(polygons.end(), src.polygons, src.polygons + src.polygonCount);
+    if (polygonBase > 0) {
+        for (int i = first; i < first + n; ++i) {
+            if (shape[i].polygon >= 0) shape[i].polygon += polygonBase;
+        }
+    }
+
+    for (int i = 0; i < n; ++i) handleOfIndex.push_back(AllocateHandle(first + i));
+    if (n > 0) ++layoutVersion;
+    return first;
+}
+
+int BodyStore::AddPolygon(const ConvexPolygon& poly) {
+    if (!polygons.empty() && SamePolygon(polygons.back(), poly)) return (int)polygons.size() - 1;
+    polygons.push_back(poly);
+    return (int)polygons.size() - 1;
+}
+
+// Reuses the most recently freed id, else grows the table
+int BodyStore::AllocateHandle(int index) {
+    if (!freeHandles.empty()) {
+        int id = freeHandles.back();
+        freeHandles.pop_back();
+        indexOfHandle[id] = index;
+        return id;
+    }
+    indexOfHandle.push_back(index);
+    generationOfHandle.push_back(0);
+    return (int)indexOfHandle.size() - 1;
+}
+
+void BodyStore::Clear() {
+    position.clear();
+    rotation.clear();
+    velocity.clear();
+    angularVelocity.clear();
+    invMass.clear();
+    invInertia.clear();
+    active.clear();
+    awake.clear();
+    shape.clear();
+    sleepTime.clear();
+    material.clear();
+    game.clear();
+    polygons.clear();
+    handleOfIndex.clear();
+
+    // Keep the handle table: every live handle is retired like a removal,
+    // so handles from before the Clear never resolve to the new bodies.
+    // Ids come back lowest first, as in a fresh store.
+    freeHandles.clear();
+    for (int id = (int)indexOfHandle.size() - 1; id >= 0; --id) {
+        if (indexOfHandle[id] >= 0) ++generationOfHandle[id];
+        indexOfHandle[id] = -1;
+        freeHandles.push_back(id);
+    }
+    remap.clear();
+    removedCount = 0;
+    ++staticVersion;
+    ++layoutVersion;
+}
+
+void BodyStore::Reserve(int n) {
+    position.reserve(n);
+    rotation.reserve(n);
+    velocity.reserve(n);
+    angularVelocity.reserve(n);
+    invMass.reserve(n);
+    invInertia.reserve(n);
+    active.reserve(n);
+    awake.reserve(n);
+    shape.reserve(n);
+    sleepTime.reserve(n);
+    material.reserve(n);
+    game.reserve(n);
+    indexOfHandle.reserve(n);
+    generationOfHandle.reserve(n);
+    handleOfIndex.reserve(n);
+}
+
+void BodyStore::Remove(BodyHandle h) {
+    int index = IndexOf(h);
+    if (index >= 0) RemoveAt(index);
+}
+
+void BodyStore::RemoveAt(int index) {
+    int id = handleOfIndex[index];
+    if (id < 0) return;
+
+    active[index] = awake[index] = 0;
+    if (invMass[index] == 0.0f) ++staticVersion;
+    handleOfIndex[index] = -1;
+    indexOfHandle[id] = -1;
+    ++generationOfHandle[id];
+    freeHandles.push_back(id);
+    ++removedCount;
+    ++layoutVersion;
+}
+
+bool BodyStore::Compact() {
+    if (removedCount == 0) return false;
+
+    const int n = Count();
+    remap.assign(n, -1);
+    int out = 0;
+    bool staticMoved = false;
+    for (int i = 0; i < n; ++i) {
+        if (handleOfIndex[i] < 0) continue;
+        remap[i] = out;
+        if (out != i) {
+            if (invMass[i] == 0.0f) staticMoved = true;
+            position[out] = position[i];
+            rotation[out] = rotation[i];
+            velocity[out] = velocity[i];
+            angularVelocity[out] = angularVelocity[i];
+            invMass[out] = invMass[i];
+            invInertia[out] = invInertia[i];
+            active[out] = active[i];
+            awake[out] = awake[i];
+            shape[out] = shape[i];
+            sleepTime[out] = sleepTime[i];
+            material[out] = material[i];
+            game[out] = game[i];
+            handleOfIndex[out] = handleOfIndex[i];
+            indexOfHandle[handleOfIndex[out]] = out;
+        }
+        ++out;
+    }
+
+    position.resize(out);
+    rotation.resize(out);
+    velocity.resize(out);
+    angularVelocity.resize(out);
+    invMass.resize(out);
+    invInertia.resize(out);
+    active.resize(out);
+    awake.resize(out);
+    shape.resize(out);
+    sleepTime.resize(out);
+    material.resize(out);
+    game.resize(out);
+    handleOfIndex.resize(out);
+
+    removedCount = 0;
+    ++compactions;
+    ++layoutVersion;
+    if (staticMoved) ++staticVersion;
+    return true;
+}
+
+int BodyStore::IndexOf(BodyHandle h) const {
+    if (h.id < 0 || h.id >= (int)indexOfHandle.size()) return -1;
+    if (generationOfHandle[h.id] != h.generation) return -1;
+    return indexOfHandle[h.id];
+}
+
+BodyHandle BodyStore::HandleOf(int index) const {
+    BodyHandle h;
+    h.id = handleOfIndex[index];
+    if (h.id >= 0) h.generation = generationOfHandle[h.id];
+    return h;
+}
+
+void BodyStore::LocalBounds(int i, Vector2& lo, Vector2& hi) const {
+    const BodyShape& s = shape[i];
+    if (s.type == SHAPE_CIRCLE) {
+        lo = { -s.radius, -s.radius };
+        hi = { s.radius, s.radius };
+        return;
+    }
+    if (s.type == SHAPE_AABB || s.type == SHAPE_CHAIN) {
+        lo = { -s.halfExtents.x, -s.halfExtents.y };
+        hi = s.halfExtents;
+        return;
+    }
+
+    const ConvexPolygon& poly = polygons[s.polygon];
+    lo = hi = Rotate(rotation[i], poly.vertices[0]);
+    for (int k = 1; k < poly.count; ++k) {
+        Vector2 v = Rotate(rotation[i], poly.vertices[k]);
+        lo = { min(lo.x, v.x), min(lo.y, v.y) };
+        hi = { max(hi.x, v.x), max(hi.y, v.y) };
+    }
+}
+
+Body BodyStore::Get(int index) const {
+    Body b;
+    b.position = position[index];
+    b.velocity = velocity[index];
+    b.angle = AngleOf(rotation[index]);
+    b.angularVelocity = angularVelocity[index];
+    b.radius = shape[index].radius;
+    b.halfExtents = shape[index].halfExtents;
+    if (shape[index].polygon >= 0) b.polygon = polygons[shape[index].polygon];
+    b.chain = shape[index].chain;
+    b.mass = material[index].mass;
+    b.invMass = invMass[index];
+    b.invInertia = invInertia[index];
+    b.restitution = material[index].restitution;
+    b.friction = material[index].friction;
+    b.shape = shape[index].type;
+    b.type = game[index].type;
+    b.color = game[index].color;
+    b.active = active[index] != 0;
+    b.alive = game[index].alive;
+    b.toughness = game[index].toughness;
+    return b;
+}
+
+BodyArrays BodyStore::View(int first) const {
+    BodyArrays v;
+    v.count = Count() - first;
+    v.position = position.data() + first;
+    v.rotation = rotation.data() + first;
+    v.velocity = velocity.data() + first;
+    v.angularVelocity = angularVelocity.data() + first;
+    v.invMass = invMass.data() + first;
+    v.invInertia = invInertia.data() + first;
+    v.active = active.data() + first;
+    v.shape = shape.data() + first;
+    v.material = material.data() + first;
+    v.game = game.data() + first;
+    v.polygonCount = (int)polygons.size();
+    v.polygons = polygons.data();
+    return v;
+}
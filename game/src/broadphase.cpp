@@ -0,0 +1,294 @@
+#include "fp_mode.h"
+#include "broadphase.h"
+#include "job_system.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+const char* BroadphaseModeName(BroadphaseMode mode) {
+    switch (mode) {
+    case BROADPHASE_BRUTE_FORCE: return "Brute force";
+    case BROADPHASE_GRID:        return "Uniform grid";
+    case BROADPHASE_SAP:         return "Sweep and prune";
+    case BROADPHASE_TREE:        return "AABB tree";
+    default:                     return "?";
+    }
+}
+
+// ------------------------------------------------------------
+// Brute force
+
+void BruteForcePairs(const vector<BroadphaseProxy>& proxies, vector<BodyPair>& pairs) {
+    const size_t n = proxies.size();
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i + 1; j < n; ++j) {
+            AddCandidatePair(proxies[i], proxies[j], pairs);
+        }
+    }
+    sort(pairs.begin(), pairs.end());
+}
+
+void BruteForceQuery(const vector<BroadphaseProxy>& proxies, const AABB& region, vector<int>& out) {
+    for (const BroadphaseProxy& p : proxies) {
+        if (p.body >= 0 && AABBOverlaps(p.box, region)) out.push_back(p.body);
+    }
+}
+
+// ------------------------------------------------------------
+// Uniform grid
+
+static inline uint64_t CellKey(int cx, int cy) {
+    // pack two signed cell coords into one sortable key
+    return ((uint64_t)(uint32_t)cy << 32) | (uint64_t)(uint32_t)cx;
+}
+
+void UniformGrid::FindPairs(const vector<BroadphaseProxy>& proxies, vector<BodyPair>& pairs, JobSystem* jobs) {
+    entries.clear();
+    oversize.clear();
+
+    const float inv = 1.0f / cellSize;
+
+    // (1) bin every proxy into the cells its box covers
+    for (int i = 0; i < (int)proxies.size(); ++i) {
+        const AABB& box = proxies[i].box;
+        int x0 = (int)floorf(box.min.x * inv);
+        int y0 = (int)floorf(box.min.y * inv);
+        int x1 = (int)floorf(box.max.x * inv);
+        int y1 = (int)floorf(box.max.y * inv);
+
+        if ((x1 - x0 + 1) * (y1 - y0 + 1) > maxCellsPerProxy) {
+            oversize.push_back(i);
+            continue;
+        }
+
+        for (int cy = y0; cy <= y1; ++cy) {
+            for (int cx = x0; cx <= x1; ++cx) {
+                entries.push_back({ CellKey(cx, cy), i });
+            }
+        }
+    }
+
+    // (2) group entries by cell, then pair up everything inside a cell
+    sort(entries.begin(), entries.end(), [](const CellEntry& l, const CellEntry& r) {
+        return (l.cell != r.cell) ? (l.cell < r.cell) : (l.proxy < r.proxy);
+    });
+
+    cellStart.clear();
+    for (int e = 0; e < (int)entries.size(); ++e) {
+        if (e == 0 || entries[e].cell != entries[e - 1].cell) cellStart.push_back(e);
+    }
+    const int cellCount = (int)cellStart.size();
+    cellStart.push_back((int)entries.size());
+
+    // Cells are independent: jobs fill their own pair lists, which are then
+    // appended in job order (job boundaries don't depend on thread count)
+    const int jobCount = (cellCount + cellsPerJob - 1) / cellsPerJob;
+    if (jobPairs.size() < (size_t)jobCount) jobPairs.resize(jobCount);
+
+    auto pairCells = [this, &proxies](int first, int last) {
+        vector<BodyPair>& out = jobPairs[first / cellsPerJob];
+        out.clear();
+        for (int c = first; c < last; ++c) {
+            for (int i = cellStart[c]; i < cellStart[c + 1]; ++i) {
+                for (int j = i + 1; j < cellStart[c + 1]; ++j) {
+                    AddCandidatePair(proxies[entries[i].proxy], proxies[entries[j].proxy], out);
+                }
+            }
+        }
+    };
+    if (jobs) jobs->ParallelFor(cellCount, cellsPerJob, pairCells);
+    else {
+        for (int first = 0; first < cellCount; first += cellsPerJob) pairCells(first, min(first + cellsPerJob, cellCount));
+    }
+    for (int j = 0; j < jobCount; ++j) pairs.insert(pairs.end(), jobPairs[j].begin(), jobPairs[j].end());
+
+    // (3) oversize proxies are tested against all others directly
+    for (size_t k = 0; k < oversize.size(); ++k) {
+        const BroadphaseProxy& big = proxies[oversize[k]];
+        for (int i = 0; i < (int)proxies.size(); ++i) {
+            if (i == oversize[k]) continue;
+            // oversize-oversize pairs only once
+            if (i < oversize[k] && binary_search(oversize.begin(), oversize.end(), i)) continue;
+            AddCandidatePair(big, proxies[i], pairs);
+        }
+    }
+
+    // (4) a pair sharing several cells shows up several times
+    sort(pairs.begin(), pairs.end());
+    pairs.erase(unique(pairs.begin(), pairs.end()), pairs.end());
+}
+
+void UniformGrid::Query(const AABB& region, const vector<BroadphaseProxy>& proxies, vector<int>& out) const {
+    const float inv = 1.0f / cellSize;
+    const int x0 = (int)floorf(region.min.x * inv);
+    const int y0 = (int)floorf(region.min.y * inv);
+    const int x1 = (int)floorf(region.max.x * inv);
+    const int y1 = (int)floorf(region.max.y * inv);
+
+    // a region over more cells than there are entries: just test them all
+    if ((double)(x1 - x0 + 1) * (y1 - y0 + 1) > (double)entries.size()) {
+        BruteForceQuery(proxies, region, out);
+        return;
+    }
+
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            const uint64_t key = CellKey(cx, cy);
+            auto it = lower_bound(entries.begin(), entries.end(), key,
+                [](const CellEntry& e, uint64_t k) { return e.cell < k; });
+            for (; it != entries.end() && it->cell == key; ++it) {
+                const BroadphaseProxy& p = proxies[it->proxy];
+                if (p.body < 0 || !AABBOverlaps(p.box, region)) continue;
+                // a proxy over several cells is reported from the first
+                // cell it shares with the region only
+                int px = max(x0, (int)floorf(p.box.min.x * inv));
+                int py = max(y0, (int)floorf(p.box.min.y * inv));
+                if (px == cx && py == cy) out.push_back(p.body);
+            }
+        }
+    }
+    for (int i : oversize) {
+        const BroadphaseProxy& p = proxies[i];
+        if (p.body >= 0 && AABBOverlaps(p.box, region)) out.push_back(p.body);
+    }
+}
+
+// ------------------------------------------------------------
+// Sweep and prune
+
+// at equal values min endpoints go first so touching boxes still overlap
+static inline bool EndpointLess(const SweepAndPrune::Endpoint& l, const SweepAndPrune::Endpoint& r) {
+    if (l.value != r.value) return l.value < r.value;
+    return l.isMin && !r.isMin;
+}
+
+static int InsertionSort(vector<SweepAndPrune::Endpoint>& list) {
+    int swaps = 0;
+    for (size_t i = 1; i < list.size(); ++i) {
+        SweepAndPrune::Endpoint e = list[i];
+        size_t j = i;
+        while (j > 0 && EndpointLess(e, list[j - 1])) {
+            list[j] = list[j - 1];
+            --j;
+            ++swaps;
+        }
+        list[j] = e;
+    }
+    return swaps;
+}
+
+static inline float AxisOf(const Vector2& v, int axis) {
+    return (axis == 0) ? v.x : v.y;
+}
+
+void SweepAndPrune::Remap(const vector<int>& newIndex) {
+    for (vector<Endpoint>& list : axis) {
+        size_t out = 0;
+        for (Endpoint e : list) {
+            e.body = (e.body < (int)newIndex.size()) ? newIndex[e.body] : -1;
+            if (e.body >= 0) list[out++] = e;
+        }
+        list.resize(out);
+    }
+
+    // Query still looks proxies up by body until the next FindPairs
+    vector<int> moved(proxyOfBody.size(), -1);
+    for (size_t b = 0; b < proxyOfBody.size() && b < newIndex.size(); ++b) {
+        if (newIndex[b] >= 0) moved[newIndex[b]] = proxyOfBody[b];
+    }
+    proxyOfBody.swap(moved);
+}
+
+void SweepAndPrune::Query(const AABB& region, const vector<BroadphaseProxy>& proxies, vector<int>& out) const {
+    // no box that starts left of this can reach the region
+    const Endpoint from = { region.min.x - widest, -1, true };
+    const vector<Endpoint>& list = axis[0];
+    for (auto it = lower_bound(list.begin(), list.end(), from, EndpointLess); it != list.end(); ++it) {
+        if (it->value > region.max.x) break;
+        if (!it->isMin) continue;
+        const BroadphaseProxy& p = proxies[proxyOfBody[it->body]];
+        if (AABBOverlaps(p.box, region)) out.push_back(it->body);
+    }
+}
+
+void SweepAndPrune::FindPairs(const vector<BroadphaseProxy>& proxies, vector<BodyPair>& pairs) {
+    // (1) map body index -> proxy for this step
+    int maxBody = -1;
+    for (const BroadphaseProxy& p : proxies) maxBody = max(maxBody, p.body);
+    proxyOfBody.assign(maxBody + 1, -1);
+    for (int i = 0; i < (int)proxies.size(); ++i) proxyOfBody[proxies[i].body] = i;
+
+    // (2) refresh both endpoint lists in place, keeping their order
+    swapCount = 0;
+    for (int k = 0; k < 2; ++k) {
+        vector<Endpoint>& list = axis[k];
+        inList.assign(maxBody + 1, 0);
+
+        // drop endpoints of bodies that went away, update the rest
+        size_t out = 0;
+        for (size_t i = 0; i < list.size(); ++i) {
+            Endpoint e = list[i];
+            if (e.body > maxBody || proxyOfBody[e.body] < 0) continue;
+            const AABB& box = proxies[proxyOfBody[e.body]].box;
+            e.value = e.isMin ? AxisOf(box.min, k) : AxisOf(box.max, k);
+            inList[e.body] = 1;
+            list[out++] = e;
+        }
+        list.resize(out);
+
+        // append bodies that are new this step
+        for (const BroadphaseProxy& p : proxies) {
+            if (inList[p.body]) continue;
+            list.push_back({ AxisOf(p.box.min, k), p.body, true });
+            list.push_back({ AxisOf(p.box.max, k), p.body, false });
+        }
+
+        swapCount += InsertionSort(list);
+    }
+
+    // (3) sweep along the axis with the larger spread of centers
+    float mean[2] = { 0.0f, 0.0f };
+    float var[2] = { 0.0f, 0.0f };
+    if (!proxies.empty()) {
+        for (const BroadphaseProxy& p : proxies) {
+            mean[0] += 0.5f * (p.box.min.x + p.box.max.x);
+            mean[1] += 0.5f * (p.box.min.y + p.box.max.y);
+        }
+        mean[0] /= (float)proxies.size();
+        mean[1] /= (float)proxies.size();
+        for (const BroadphaseProxy& p : proxies) {
+            float cx = 0.5f * (p.box.min.x + p.box.max.x) - mean[0];
+            float cy = 0.5f * (p.box.min.y + p.box.max.y) - mean[1];
+            var[0] += cx * cx;
+            var[1] += cy * cy;
+        }
+    }
+    sweepAxis = (var[1] > var[0]) ? 1 : 0;
+
+    widest = 0.0f;
+    for (const BroadphaseProxy& p : proxies) widest = max(widest, p.box.max.x - p.box.min.x);
+
+    // (4) sweep: every min endpoint overlaps all intervals still open
+    sweepOverlaps = 0;
+    size_t first = pairs.size();
+    open.clear();
+    for (const Endpoint& e : axis[sweepAxis]) {
+        int pi = proxyOfBody[e.body];
+        if (!e.isMin) {
+            auto it = find(open.begin(), open.end(), pi);
+            *it = open.back();
+            open.pop_back();
+            continue;
+        }
+        for (int other : open) {
+            ++sweepOverlaps;
+            AddCandidatePair(proxies[pi], proxies[other], pairs);
+        }
+        open.push_back(pi);
+    }
+
+    sort(pairs.begin() + first, pairs.end());
+    candidateCount = (int)(pairs.size() - first);
+}
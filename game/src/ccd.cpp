@@ -0,0 +1,212 @@
+#include "fp_mode.h"
+#include "ccd.h"
+#include "raymath.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// ------------------------------------------------------------
+// Segment tests (p0 + d * t, t in [0, 1])
+
+// Slab test; entry time into the box
+static bool SegmentBox(Vector2 p0, Vector2 d, Vector2 c, Vector2 half, float& t) {
+    float tEnter = 0.0f, tExit = 1.0f;
+    const float p[2] = { p0.x, p0.y };
+    const float dir[2] = { d.x, d.y };
+    const float lo[2] = { c.x - half.x, c.y - half.y };
+    const float hi[2] = { c.x + half.x, c.y + half.y };
+
+    for (int axis = 0; axis < 2; ++axis) {
+        if (fabsf(dir[axis]) < 1e-9f) {
+            if (p[axis] < lo[axis] || p[axis] > hi[axis]) return false;
+            continue;
+        }
+        float inv = 1.0f / dir[axis];
+        float t0 = (lo[axis] - p[axis]) * inv;
+        float t1 = (hi[axis] - p[axis]) * inv;
+        if (t0 > t1) swap(t0, t1);
+        tEnter = max(tEnter, t0);
+        tExit = min(tExit, t1);
+        if (tEnter > tExit) return false;
+    }
+    t = tEnter;
+    return true;
+}
+
+static bool SegmentCircle(Vector2 p0, Vector2 d, Vector2 c, float radius, float& t) {
+    Vector2 m = Vector2Subtract(p0, c);
+    float a = Vector2DotProduct(d, d);
+    float b = Vector2DotProduct(m, d);
+    float k = Vector2DotProduct(m, m) - radius * radius;
+    if (a <= 0.0f) return false;
+
+    float disc = b * b - a * k;
+    if (disc < 0.0f) return false;
+
+    float hit = (-b - sqrtf(disc)) / a;
+    if (hit < 0.0f || hit > 1.0f) return false;
+    t = hit;
+    return true;
+}
+
+static bool InsideRoundedBox(Vector2 p, Vector2 c, Vector2 half, float radius) {
+    float dx = fabsf(p.x - c.x) - half.x;
+    float dy = fabsf(p.y - c.y) - half.y;
+    if (dx < 0.0f && dy < radius) return true;
+    if (dy < 0.0f && dx < radius) return true;
+    return dx * dx + dy * dy < radius * radius;
+}
+
+// The rounded box is the union of two boxes (one widened, one heightened)
+// and four corner circles, so its entry time is the earliest of theirs.
+bool SegmentRoundedBoxTOI(Vector2 p0, Vector2 d, Vector2 c, Vector2 half, float radius, float& t) {
+    if (InsideRoundedBox(p0, c, half, radius)) return false;
+
+    float best = 2.0f, hit;
+    if (SegmentBox(p0, d, c, { half.x + radius, half.y }, hit)) best = min(best, hit);
+    if (radius > 0.0f) {
+        if (SegmentBox(p0, d, c, { half.x, half.y + radius }, hit)) best = min(best, hit);
+        const Vector2 corners[4] = {
+            { c.x - half.x, c.y - half.y }, { c.x + half.x, c.y - half.y },
+            { c.x - half.x, c.y + half.y }, { c.x + half.x, c.y + half.y }
+        };
+        for (const Vector2& corner : corners) {
+            if (SegmentCircle(p0, d, corner, radius, hit)) best = min(best, hit);
+        }
+    }
+    if (best > 1.0f) return false;
+    t = best;
+    return true;
+}
+
+// Body i as a box (center offset from its position, half extents) grown by
+// a radius. Polygons sweep as their bounding box at the current rotation:
+// exact for upright blocks, a little early for tilted ones.
+static void SweepShape(const BodyStore& bodies, int i, Vector2& offset, Vector2& half, float& radius) {
+    if (bodies.shape[i].type == SHAPE_CIRCLE) {
+        offset = half = { 0.0f, 0.0f };
+        radius = bodies.shape[i].radius;
+        return;
+    }
+    Vector2 lo, hi;
+    bodies.LocalBounds(i, lo, hi);
+    offset = Vector2Scale(Vector2Add(lo, hi), 0.5f);
+    half = Vector2Scale(Vector2Subtract(hi, lo), 0.5f);
+    radius = 0.0f;
+}
+
+bool SweptTimeOfImpact(const BodyStore& bodies, int a, Vector2 from, Vector2 to, int b, float& t) {
+    Vector2 offA, halfA, offB, halfB;
+    float rA, rB;
+    SweepShape(bodies, a, offA, halfA, rA);
+    SweepShape(bodies, b, offB, halfB, rB);
+    Vector2 d = Vector2Subtract(to, from);
+
+    // Minkowski sums: circle+circle = circle, box+box = box, circle+box = rounded box
+    return SegmentRoundedBoxTOI(Vector2Add(from, offA), d, Vector2Add(bodies.position[b], offB),
+        Vector2Add(halfA, halfB), rA + rB, t);
+}
+
+// The box's reach along the segment's normal and along the segment decide
+// when it touches the line and whether that is within the segment
+bool SweptSegmentTimeOfImpact(const BodyStore& bodies, int a, Vector2 from, Vector2 to,
+    const TerrainSegment& seg, float& t) {
+    Vector2 offset, half;
+    float radius;
+    SweepShape(bodies, a, offset, half, radius);
+    Vector2 c0 = Vector2Add(from, offset);
+    Vector2 d = Vector2Subtract(to, from);
+
+    const Vector2 n = seg.normal;
+    float approach = Vector2DotProduct(d, n);
+    if (approach >= 0.0f) return false;
+
+    float reach = radius + fabsf(n.x) * half.x + fabsf(n.y) * half.y;
+    float gap = Vector2DotProduct(Vector2Subtract(c0, seg.v1), n) - reach;
+    if (gap < 0.0f || gap + approach >= 0.0f) return false;
+    float hit = gap / -approach;
+
+    Vector2 e = Vector2Subtract(seg.v2, seg.v1);
+    float len = Vector2Length(e);
+    Vector2 u = Vector2Scale(e, 1.0f / len);
+    float side = radius + fabsf(u.x) * half.x + fabsf(u.y) * half.y;
+    float along = Vector2DotProduct(Vector2Subtract(Vector2Add(c0, Vector2Scale(d, hit)), seg.v1), u);
+    if (along + side < 0.0f || along - side > len) return false;
+
+    t = hit;
+    return true;
+}
+
+// ------------------------------------------------------------
+
+void ContinuousCollision::FindFastBodies(const BodyStore& bodies, float dt) {
+    const int n = bodies.Count();
+    fast.assign(n, 0);
+    start.resize(n);
+    toi.resize(n);
+    fastList.clear();
+    fastCount = 0;
+    hitCount = 0;
+    segmentsSwept = 0;
+    if (!enabled) return;
+
+    for (int i = 0; i < n; ++i) {
+        if (!bodies.awake[i] || bodies.invMass[i] == 0.0f) continue;
+
+        const BodyShape& s = bodies.shape[i];
+        float size = (s.type == SHAPE_CIRCLE) ? s.radius : min(s.halfExtents.x, s.halfExtents.y);
+        Vector2 step = Vector2Scale(bodies.velocity[i], dt);
+        if (Vector2Length(step) <= motionFraction * size) continue;
+
+        fast[i] = 1;
+        start[i] = Vector2Subtract(bodies.position[i], step);
+        toi[i] = 1.0f;
+        fastList.push_back(i);
+    }
+    fastCount = (int)fastList.size();
+}
+
+void ContinuousCollision::Sweep(BodyStore& bodies, const vector<BodyPair>& pairs, const Terrain& terrain,
+    const vector<int>& chainBodies) {
+    if (fastList.empty()) return;
+
+    // earliest impact per fast body (min over pairs, so pair order doesn't matter)
+    for (const BodyPair& p : pairs) {
+        float t;
+        if (fast[p.a] && SweptTimeOfImpact(bodies, p.a, start[p.a], bodies.position[p.a], p.b, t)) {
+            toi[p.a] = min(toi[p.a], t);
+        }
+        if (fast[p.b] && SweptTimeOfImpact(bodies, p.b, start[p.b], bodies.position[p.b], p.a, t)) {
+            toi[p.b] = min(toi[p.b], t);
+        }
+    }
+
+    // terrain: every segment near the step's path (same min, so the order
+    // the BVH visits them in doesn't matter either)
+    for (int i : fastList) {
+        Vector2 lo, hi;
+        bodies.LocalBounds(i, lo, hi);
+        Vector2 from = start[i], to = bodies.position[i];
+        AABB path;
+        path.min = Vector2Add(Vector2Min(from, to), lo);
+        path.max = Vector2Add(Vector2Max(from, to), hi);
+        terrain.Query(path, [&](int segment) {
+            const TerrainSegment& seg = terrain.segments[segment];
+            if (seg.chain >= (int)chainBodies.size() || chainBodies[seg.chain] < 0) return;
+            ++segmentsSwept;
+            float t;
+            if (SweptSegmentTimeOfImpact(bodies, i, from, to, seg, t)) toi[i] = min(toi[i], t);
+        });
+    }
+
+    // pull back to the impact, a skin's width into the target
+    for (int i : fastList) {
+        if (toi[i] >= 1.0f) continue;
+        Vector2 d = Vector2Subtract(bodies.position[i], start[i]);
+        float t = min(1.0f, toi[i] + skin / Vector2Length(d));
+        bodies.position[i] = Vector2Add(start[i], Vector2Scale(d, t));
+        ++hitCount;
+    }
+}
@@ -0,0 +1,90 @@
+#include "fp_mode.h"
+#include "contact_events.h"
+#include "raymath.h"
+
+#include <cmath>
+
+using namespace std;
+
+static inline Vector2 MiddlePoint(const ContactManifold& m) {
+    if (m.pointCount == 0) return { 0.0f, 0.0f };
+    Vector2 sum = m.points[0].position;
+    for (int k = 1; k < m.pointCount; ++k) sum = Vector2Add(sum, m.points[k].position);
+    return Vector2Scale(sum, 1.0f / (float)m.pointCount);
+}
+
+static ContactEvent EventOf(const BodyStore& bodies, const ContactManifold& m, ContactEventType type) {
+    ContactEvent e;
+    e.type = type;
+    e.a = bodies.HandleOf(m.a);
+    e.b = bodies.HandleOf(m.b);
+    e.typeA = bodies.game[m.a].type;
+    e.typeB = bodies.game[m.b].type;
+    e.indexA = m.a;
+    e.indexB = m.b;
+    e.child = m.child;
+    e.point = MiddlePoint(m);
+    e.normal = m.normal;
+    return e;
+}
+
+void ContactEventStream::Prepare(const BodyStore& bodies, const vector<ContactManifold>& manifolds) {
+    pending.resize(manifolds.size());
+    for (size_t i = 0; i < manifolds.size(); ++i) {
+        const ContactManifold& m = manifolds[i];
+        ContactEvent& e = pending[i];
+        e = EventOf(bodies, m, (m.age == 0) ? CONTACT_BEGIN : CONTACT_PERSIST);
+
+        Vector2 pa = Vector2Scale(bodies.velocity[m.a], bodies.material[m.a].mass);
+        Vector2 pb = Vector2Scale(bodies.velocity[m.b], bodies.material[m.b].mass);
+        e.relativeMomentum = Vector2Length(Vector2Subtract(pa, pb));
+    }
+}
+
+void ContactEventStream::Reserve(size_t capacity) {
+    size_t size = ring.empty() ? (size_t)CONTACT_EVENT_CAPACITY : ring.size();
+    while (size < capacity) size *= 2;
+    if (size == ring.size()) return;
+
+    // keep what is in the ring at the same sequence numbers
+    vector<ContactEvent> grown(size);
+    for (uint64_t s = Oldest(); s < head; ++s) grown[(size_t)(s & (size - 1))] = ring[(size_t)(s & mask)];
+    ring.swap(grown);
+    mask = size - 1;
+}
+
+void ContactEventStream::Publish(const BodyStore& bodies, const vector<ContactManifold>& manifolds,
+    const vector<ContactManifold>& ended, int step) {
+    const size_t total = manifolds.size() + ended.size();
+    Reserve(total);
+
+    begins = 0;
+    for (size_t i = 0; i < manifolds.size(); ++i) {
+        const ContactManifold& m = manifolds[i];
+        ContactEvent& e = pending[i];
+        e.step = step;
+        e.normalImpulse = e.tangentImpulse = 0.0f;
+        for (int k = 0; k < m.pointCount; ++k) {
+            e.normalImpulse += m.points[k].normalImpulse;
+            e.tangentImpulse += fabsf(m.points[k].tangentImpulse);
+        }
+        if (e.type == CONTACT_BEGIN) ++begins;
+        ring[(size_t)(head++ & mask)] = e;
+    }
+    for (const ContactManifold& m : ended) {
+        // the bodies may be gone already; their handles then come back stale
+        ContactEvent e = EventOf(bodies, m, CONTACT_END);
+        e.step = step;
+        ring[(size_t)(head++ & mask)] = e;
+    }
+
+    count = min<uint64_t>(count + total, ring.size());
+    published = (int)total;
+    ends = (int)ended.size();
+}
+
+void ContactEventStream::Clear() {
+    count = 0;
+    pending.clear();
+    published = begins = ends = 0;
+}
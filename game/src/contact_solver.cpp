@@ -0,0 +1,618 @@
+#include "fp_mode.h"
+#include "contact_solver.h"
+#include "simd_integrate.h"
+
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <emmintrin.h>
+#else
+#define SIMD_X86 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#else
+#define TARGET_SSE2
+#endif
+
+using namespace std;
+
+// Above this condition number (k11^2 / det) the two normal rows are nearly
+// the same row, and the block solve would blow up; one point is enough then
+const float MAX_BLOCK_CONDITION = 1000.0f;
+
+static inline float Cross(Vector2 a, Vector2 b) {
+    return a.x * b.y - a.y * b.x;
+}
+
+// Velocity of b's contact point relative to a's (v + w x r on each side)
+static inline Vector2 RelativeVelocity(const BodyStore& bodies, const ContactConstraint& c, const ContactConstraintPoint& p) {
+    const Vector2 va = bodies.velocity[c.a];
+    const Vector2 vb = bodies.velocity[c.b];
+    const float wa = bodies.angularVelocity[c.a];
+    const float wb = bodies.angularVelocity[c.b];
+    return { (vb.x - wb * p.rB.y) - (va.x - wa * p.rA.y),
+             (vb.y + wb * p.rB.x) - (va.y + wa * p.rA.x) };
+}
+
+void ContactSolver::Prepare(const BodyStore& bodies, const vector<ContactManifold>& manifolds,
+    const IslandManager& islands) {
+    const float invDt = (timeStep > 0.0f) ? 1.0f / timeStep : 0.0f;
+
+    constraints.clear();
+    for (int m = 0; m < (int)manifolds.size(); ++m) {
+        const ContactManifold& cm = manifolds[m];
+        int a = cm.a, b = cm.b;
+        if (!bodies.active[a] || !bodies.active[b]) continue;
+
+        float invA = bodies.invMass[a];
+        float invB = bodies.invMass[b];
+        float invSum = invA + invB;
+        if (invSum <= 0.0f) continue; // two static objects
+
+        const BodyMaterial& ma = bodies.material[a];
+        const BodyMaterial& mb = bodies.material[b];
+
+        ContactConstraint c;
+        c.manifold = m;
+        c.island = islands.RootOf((invA > 0.0f) ? a : b);
+        c.a = a;
+        c.b = b;
+        c.normal = cm.normal;
+        c.tangent = { -cm.normal.y, cm.normal.x };
+        c.invMassA = invA;
+        c.invMassB = invB;
+        c.invInertiaA = bodies.invInertia[a];
+        c.invInertiaB = bodies.invInertia[b];
+        c.friction = 0.5f * (ma.friction + mb.friction);
+        c.pointCount = cm.pointCount;
+        const float restitution = min(ma.restitution, mb.restitution);
+
+        for (int k = 0; k < cm.pointCount; ++k) {
+            const ManifoldPoint& mp = cm.points[k];
+            ContactConstraintPoint& p = c.points[k];
+            p.rA = Vector2Subtract(mp.position, bodies.position[a]);
+            p.rB = Vector2Subtract(mp.position, bodies.position[b]);
+
+            float rnA = Cross(p.rA, c.normal), rnB = Cross(p.rB, c.normal);
+            float rtA = Cross(p.rA, c.tangent), rtB = Cross(p.rB, c.tangent);
+            p.normalMass = 1.0f / (invSum + c.invInertiaA * rnA * rnA + c.invInertiaB * rnB * rnB);
+            p.tangentMass = 1.0f / (invSum + c.invInertiaA * rtA * rtA + c.invInertiaB * rtB * rtB);
+
+            // Overlap is worked off a share per step; points still apart may
+            // close the gap this step but no more. Bounce only for real
+            // impacts, measured before any impulse this step.
+            float push = (mp.penetration < 0.0f) ? mp.penetration * invDt
+                                                 : baumgarte * invDt * max(mp.penetration - penetrationSlop, 0.0f);
+            float vn = Vector2DotProduct(RelativeVelocity(bodies, c, p), c.normal);
+            p.velocityBias = (vn < -restitutionThreshold) ? max(-restitution * vn, push) : push;
+
+            if (warmStarting) {
+                p.normalImpulse = mp.normalImpulse;
+                p.tangentImpulse = mp.tangentImpulse;
+            }
+        }
+
+        if (c.pointCount == 2) {
+            const ContactConstraintPoint& p1 = c.points[0];
+            const ContactConstraintPoint& p2 = c.points[1];
+            float rn1A = Cross(p1.rA, c.normal), rn1B = Cross(p1.rB, c.normal);
+            float rn2A = Cross(p2.rA, c.normal), rn2B = Cross(p2.rB, c.normal);
+            c.k11 = invSum + c.invInertiaA * rn1A * rn1A + c.invInertiaB * rn1B * rn1B;
+            c.k22 = invSum + c.invInertiaA * rn2A * rn2A + c.invInertiaB * rn2B * rn2B;
+            c.k12 = invSum + c.invInertiaA * rn1A * rn2A + c.invInertiaB * rn1B * rn2B;
+            float det = c.k11 * c.k22 - c.k12 * c.k12;
+            if (c.k11 * c.k11 < MAX_BLOCK_CONDITION * det) {
+                float invDet = 1.0f / det;
+                c.blockMass11 = c.k22 * invDet;
+                c.blockMass12 = -c.k12 * invDet;
+                c.blockMass22 = c.k11 * invDet;
+            }
+            else {
+                c.pointCount = 1;   // the points (nearly) coincide
+            }
+        }
+        constraints.push_back(c);
+    }
+
+    // Group by island; stable, so each island keeps the manifold order
+    stable_sort(constraints.begin(), constraints.end(), [](const ContactConstraint& l, const ContactConstraint& r) {
+        return l.island < r.island;
+    });
+
+    islandRanges.clear();
+    for (int k = 0; k < (int)constraints.size(); ++k) {
+        if (k == 0 || constraints[k].island != constraints[k - 1].island) islandRanges.push_back({ k, k });
+        islandRanges.back().end = k + 1;
+    }
+}
+
+// ------------------------------------------------------------
+// Row math (one row = one manifold), shared by the island solver, the
+// colored solver and the leftovers of the SIMD batches.
+// Static bodies are shared between rows that run on different threads, so
+// only dynamic bodies ever get written.
+
+static inline void ApplyImpulse(BodyStore& bodies, const ContactConstraint& c, const ContactConstraintPoint& p, const Vector2& P) {
+    if (c.invMassA > 0.0f) {
+        bodies.velocity[c.a] = Vector2Subtract(bodies.velocity[c.a], Vector2Scale(P, c.invMassA));
+        bodies.angularVelocity[c.a] -= c.invInertiaA * Cross(p.rA, P);
+    }
+    if (c.invMassB > 0.0f) {
+        bodies.velocity[c.b] = Vector2Add(bodies.velocity[c.b], Vector2Scale(P, c.invMassB));
+        bodies.angularVelocity[c.b] += c.invInertiaB * Cross(p.rB, P);
+    }
+}
+
+static inline void WarmStartRow(BodyStore& bodies, const ContactConstraint& c) {
+    for (int k = 0; k < c.pointCount; ++k) {
+        const ContactConstraintPoint& p = c.points[k];
+        ApplyImpulse(bodies, c, p, Vector2Add(Vector2Scale(c.normal, p.normalImpulse), Vector2Scale(c.tangent, p.tangentImpulse)));
+    }
+}
+
+static inline void SolveVelocityRow(BodyStore& bodies, ContactConstraint& c) {
+    // --- Friction (Coulomb cone from the current normal impulse), per point ---
+    for (int k = 0; k < c.pointCount; ++k) {
+        ContactConstraintPoint& p = c.points[k];
+        float vt = Vector2DotProduct(RelativeVelocity(bodies, c, p), c.tangent);
+        float maxFriction = c.friction * p.normalImpulse;
+        float oldTangent = p.tangentImpulse;
+        p.tangentImpulse = Clamp(oldTangent - vt * p.tangentMass, -maxFriction, maxFriction);
+        ApplyImpulse(bodies, c, p, Vector2Scale(c.tangent, p.tangentImpulse - oldTangent));
+    }
+
+    // --- Normal (accumulated impulse never pulls bodies together) ---
+    if (c.pointCount == 1) {
+        ContactConstraintPoint& p = c.points[0];
+        float vn = Vector2DotProduct(RelativeVelocity(bodies, c, p), c.normal);
+        float oldNormal = p.normalImpulse;
+        p.normalImpulse = max(oldNormal - (vn - p.velocityBias) * p.normalMass, 0.0f);
+        ApplyImpulse(bodies, c, p, Vector2Scale(c.normal, p.normalImpulse - oldNormal));
+        return;
+    }
+
+    // Both points at once: find x >= 0 with K x + b >= 0 and x . (K x + b) = 0,
+    // where b is the normal velocity the old impulses a leave out. Tried in
+    // order: both pushing, only the first, only the second, neither. If none
+    // fits (rounding), the impulses stay as they are.
+    ContactConstraintPoint& p1 = c.points[0];
+    ContactConstraintPoint& p2 = c.points[1];
+    float a1 = p1.normalImpulse, a2 = p2.normalImpulse;
+    float vn1 = Vector2DotProduct(RelativeVelocity(bodies, c, p1), c.normal);
+    float vn2 = Vector2DotProduct(RelativeVelocity(bodies, c, p2), c.normal);
+    float b1 = vn1 - p1.velocityBias - (c.k11 * a1 + c.k12 * a2);
+    float b2 = vn2 - p2.velocityBias - (c.k12 * a1 + c.k22 * a2);
+
+    float x1 = -(c.blockMass11 * b1 + c.blockMass12 * b2);
+    float x2 = -(c.blockMass12 * b1 + c.blockMass22 * b2);
+    if (!(x1 >= 0.0f && x2 >= 0.0f)) {
+        x1 = -b1 * p1.normalMass;
+        x2 = 0.0f;
+        if (!(x1 >= 0.0f && c.k12 * x1 + b2 >= 0.0f)) {
+            x1 = 0.0f;
+            x2 = -b2 * p2.normalMass;
+            if (!(x2 >= 0.0f && c.k12 * x2 + b1 >= 0.0f)) {
+                x2 = 0.0f;
+                if (!(b1 >= 0.0f && b2 >= 0.0f)) {
+                    x1 = a1;
+                    x2 = a2;
+                }
+            }
+        }
+    }
+    p1.normalImpulse = x1;
+    p2.normalImpulse = x2;
+    ApplyImpulse(bodies, c, p1, Vector2Scale(c.normal, x1 - a1));
+    ApplyImpulse(bodies, c, p2, Vector2Scale(c.normal, x2 - a2));
+}
+
+void ContactSolver::SolveIsland(BodyStore& bodies, int begin, int end) {
+    if (warmStarting) {
+        for (int k = begin; k < end; ++k) WarmStartRow(bodies, constraints[k]);
+    }
+    for (int it = 0; it < velocityIterations; ++it) {
+        for (int k = begin; k < end; ++k) SolveVelocityRow(bodies, constraints[k]);
+    }
+}
+
+// ------------------------------------------------------------
+// SSE2 rows: 4 manifolds of one color and point count per call, same
+// operation order as the scalar rows above so results match bit-for-bit.
+// Lanes never share a dynamic body; static bodies are read but never
+// written back.
+
+#if SIMD_X86
+
+struct Lanes4 {
+    alignas(16) float v[4];
+};
+
+TARGET_SSE2 static inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// v - P * inv, or v + P * inv when add is set, for both axes
+TARGET_SSE2 static inline void ApplyImpulse4(__m128& vx, __m128& vy, __m128 px, __m128 py, __m128 inv, bool add) {
+    __m128 dx = _mm_mul_ps(px, inv);
+    __m128 dy = _mm_mul_ps(py, inv);
+    vx = add ? _mm_add_ps(vx, dx) : _mm_sub_ps(vx, dx);
+    vy = add ? _mm_add_ps(vy, dy) : _mm_sub_ps(vy, dy);
+}
+
+// w - invI * (r x P), or w + ... when add is set
+TARGET_SSE2 static inline void ApplyAngular4(__m128& w, __m128 rx, __m128 ry, __m128 px, __m128 py, __m128 invI, bool add) {
+    __m128 dw = _mm_mul_ps(invI, _mm_sub_ps(_mm_mul_ps(rx, py), _mm_mul_ps(ry, px)));
+    w = add ? _mm_add_ps(w, dw) : _mm_sub_ps(w, dw);
+}
+
+// Bodies of 4 rows, gathered into registers and scattered back
+struct Bodies4 {
+    __m128 vAx, vAy, vBx, vBy, wA, wB;
+    __m128 iA, iB, iIA, iIB;
+
+    TARGET_SSE2 void Load(const BodyStore& bodies, const ContactConstraint* c) {
+        Lanes4 vax, vay, vbx, vby, wa, wb, invA, invB, invIA, invIB;
+        for (int k = 0; k < 4; ++k) {
+            vax.v[k] = bodies.velocity[c[k].a].x;  vay.v[k] = bodies.velocity[c[k].a].y;
+            vbx.v[k] = bodies.velocity[c[k].b].x;  vby.v[k] = bodies.velocity[c[k].b].y;
+            wa.v[k] = bodies.angularVelocity[c[k].a];
+            wb.v[k] = bodies.angularVelocity[c[k].b];
+            invA.v[k] = c[k].invMassA;  invB.v[k] = c[k].invMassB;
+            invIA.v[k] = c[k].invInertiaA;  invIB.v[k] = c[k].invInertiaB;
+        }
+        vAx = _mm_load_ps(vax.v);  vAy = _mm_load_ps(vay.v);
+        vBx = _mm_load_ps(vbx.v);  vBy = _mm_load_ps(vby.v);
+        wA = _mm_load_ps(wa.v);    wB = _mm_load_ps(wb.v);
+        iA = _mm_load_ps(invA.v);  iB = _mm_load_ps(invB.v);
+        iIA = _mm_load_ps(invIA.v);  iIB = _mm_load_ps(invIB.v);
+    }
+
+    TARGET_SSE2 void Store(BodyStore& bodies, const ContactConstraint* c) const {
+        Lanes4 vax, vay, vbx, vby, wa, wb;
+        _mm_store_ps(vax.v, vAx);  _mm_store_ps(vay.v, vAy);
+        _mm_store_ps(vbx.v, vBx);  _mm_store_ps(vby.v, vBy);
+        _mm_store_ps(wa.v, wA);    _mm_store_ps(wb.v, wB);
+        for (int k = 0; k < 4; ++k) {
+            if (c[k].invMassA > 0.0f) {
+                bodies.velocity[c[k].a] = { vax.v[k], vay.v[k] };
+                bodies.angularVelocity[c[k].a] = wa.v[k];
+            }
+            if (c[k].invMassB > 0.0f) {
+                bodies.velocity[c[k].b] = { vbx.v[k], vby.v[k] };
+                bodies.angularVelocity[c[k].b] = wb.v[k];
+            }
+        }
+    }
+
+    // relative velocity at the contact point, as RelativeVelocity()
+    TARGET_SSE2 void Relative(__m128 rAx, __m128 rAy, __m128 rBx, __m128 rBy, __m128& dvx, __m128& dvy) const {
+        dvx = _mm_sub_ps(_mm_sub_ps(vBx, _mm_mul_ps(wB, rBy)), _mm_sub_ps(vAx, _mm_mul_ps(wA, rAy)));
+        dvy = _mm_sub_ps(_mm_add_ps(vBy, _mm_mul_ps(wB, rBx)), _mm_add_ps(vAy, _mm_mul_ps(wA, rAx)));
+    }
+
+    TARGET_SSE2 void Apply(__m128 rAx, __m128 rAy, __m128 rBx, __m128 rBy, __m128 px, __m128 py) {
+        ApplyImpulse4(vAx, vAy, px, py, iA, false);
+        ApplyAngular4(wA, rAx, rAy, px, py, iIA, false);
+        ApplyImpulse4(vBx, vBy, px, py, iB, true);
+        ApplyAngular4(wB, rBx, rBy, px, py, iIB, true);
+    }
+};
+
+// One contact point of 4 rows
+struct Point4 {
+    __m128 rAx, rAy, rBx, rBy, nMass, tMass, bias, jn, jt;
+
+    TARGET_SSE2 void Load(const ContactConstraint* c, int point) {
+        Lanes4 rax, ray, rbx, rby, nm, tm, vb, n, t;
+        for (int k = 0; k < 4; ++k) {
+            const ContactConstraintPoint& p = c[k].points[point];
+            rax.v[k] = p.rA.x;  ray.v[k] = p.rA.y;
+            rbx.v[k] = p.rB.x;  rby.v[k] = p.rB.y;
+            nm.v[k] = p.normalMass;
+            tm.v[k] = p.tangentMass;
+            vb.v[k] = p.velocityBias;
+            n.v[k] = p.normalImpulse;
+            t.v[k] = p.tangentImpulse;
+        }
+        rAx = _mm_load_ps(rax.v);  rAy = _mm_load_ps(ray.v);
+        rBx = _mm_load_ps(rbx.v);  rBy = _mm_load_ps(rby.v);
+        nMass = _mm_load_ps(nm.v);
+        tMass = _mm_load_ps(tm.v);
+        bias = _mm_load_ps(vb.v);
+        jn = _mm_load_ps(n.v);
+        jt = _mm_load_ps(t.v);
+    }
+
+    TARGET_SSE2 void Store(ContactConstraint* c, int point) const {
+        Lanes4 n, t;
+        _mm_store_ps(n.v, jn);
+        _mm_store_ps(t.v, jt);
+        for (int k = 0; k < 4; ++k) {
+            c[k].points[point].normalImpulse = n.v[k];
+            c[k].points[point].tangentImpulse = t.v[k];
+        }
+    }
+};
+
+struct Axes4 {
+    __m128 Nx, Ny, Tx, Ty, mu;
+
+    TARGET_SSE2 void Load(const ContactConstraint* c) {
+        Lanes4 nx, ny, tx, ty, f;
+        for (int k = 0; k < 4; ++k) {
+            nx.v[k] = c[k].normal.x;   ny.v[k] = c[k].normal.y;
+            tx.v[k] = c[k].tangent.x;  ty.v[k] = c[k].tangent.y;
+            f.v[k] = c[k].friction;
+        }
+        Nx = _mm_load_ps(nx.v);  Ny = _mm_load_ps(ny.v);
+        Tx = _mm_load_ps(tx.v);  Ty = _mm_load_ps(ty.v);
+        mu = _mm_load_ps(f.v);
+    }
+};
+
+TARGET_SSE2 static inline __m128 Dot4(__m128 ax, __m128 ay, __m128 bx, __m128 by) {
+    return _mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by));
+}
+
+TARGET_SSE2 static void SolveFriction4(Bodies4& b, const Axes4& ax, Point4& p) {
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    __m128 dvx, dvy;
+    b.Relative(p.rAx, p.rAy, p.rBx, p.rBy, dvx, dvy);
+    __m128 vt = Dot4(dvx, dvy, ax.Tx, ax.Ty);
+    __m128 oldT = p.jt;
+    __m128 maxF = _mm_mul_ps(ax.mu, p.jn);
+    __m128 minF = _mm_xor_ps(maxF, signBit);
+    __m128 newT = _mm_sub_ps(oldT, _mm_mul_ps(vt, p.tMass));
+    newT = Select(_mm_cmplt_ps(newT, minF), minF, newT);   // Clamp(), same tie-breaking
+    newT = Select(_mm_cmpgt_ps(newT, maxF), maxF, newT);
+    __m128 dT = _mm_sub_ps(newT, oldT);
+    b.Apply(p.rAx, p.rAy, p.rBx, p.rBy, _mm_mul_ps(ax.Tx, dT), _mm_mul_ps(ax.Ty, dT));
+    p.jt = newT;
+}
+
+// Rows with one contact point
+TARGET_SSE2 static void SolveVelocityRows4(BodyStore& bodies, ContactConstraint* c) {
+    Bodies4 b;
+    Axes4 ax;
+    Point4 p;
+    b.Load(bodies, c);
+    ax.Load(c);
+    p.Load(c, 0);
+
+    // --- Friction ---
+    SolveFriction4(b, ax, p);
+
+    // --- Normal ---
+    __m128 dvx, dvy;
+    b.Relative(p.rAx, p.rAy, p.rBx, p.rBy, dvx, dvy);
+    __m128 vn = Dot4(dvx, dvy, ax.Nx, ax.Ny);
+    __m128 oldN = p.jn;
+    __m128 newN = _mm_sub_ps(oldN, _mm_mul_ps(_mm_sub_ps(vn, p.bias), p.nMass));
+    newN = Select(_mm_cmplt_ps(newN, _mm_setzero_ps()), _mm_setzero_ps(), newN);  // max(x, 0)
+    __m128 dN = _mm_sub_ps(newN, oldN);
+    b.Apply(p.rAx, p.rAy, p.rBx, p.rBy, _mm_mul_ps(ax.Nx, dN), _mm_mul_ps(ax.Ny, dN));
+    p.jn = newN;
+
+    p.Store(c, 0);
+    b.Store(bodies, c);
+}
+
+// Rows with two contact points: the block solve, every case worked out in
+// every lane and the first one that fits picked, in the scalar order
+TARGET_SSE2 static void SolveVelocityBlocks4(BodyStore& bodies, ContactConstraint* c) {
+    Bodies4 b;
+    Axes4 ax;
+    Point4 p1, p2;
+    b.Load(bodies, c);
+    ax.Load(c);
+    p1.Load(c, 0);
+    p2.Load(c, 1);
+
+    // --- Friction ---
+    SolveFriction4(b, ax, p1);
+    SolveFriction4(b, ax, p2);
+
+    // --- Normal ---
+    Lanes4 k11, k12, k22, m11, m12, m22;
+    for (int k = 0; k < 4; ++k) {
+        k11.v[k] = c[k].k11;  k12.v[k] = c[k].k12;  k22.v[k] = c[k].k22;
+        m11.v[k] = c[k].blockMass11;  m12.v[k] = c[k].blockMass12;  m22.v[k] = c[k].blockMass22;
+    }
+    const __m128 K11 = _mm_load_ps(k11.v), K12 = _mm_load_ps(k12.v), K22 = _mm_load_ps(k22.v);
+    const __m128 M11 = _mm_load_ps(m11.v), M12 = _mm_load_ps(m12.v), M22 = _mm_load_ps(m22.v);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+
+    __m128 dvx, dvy;
+    b.Relative(p1.rAx, p1.rAy, p1.rBx, p1.rBy, dvx, dvy);
+    __m128 vn1 = Dot4(dvx, dvy, ax.Nx, ax.Ny);
+    b.Relative(p2.rAx, p2.rAy, p2.rBx, p2.rBy, dvx, dvy);
+    __m128 vn2 = Dot4(dvx, dvy, ax.Nx, ax.Ny);
+    __m128 a1 = p1.jn, a2 = p2.jn;
+    __m128 b1 = _mm_sub_ps(_mm_sub_ps(vn1, p1.bias), _mm_add_ps(_mm_mul_ps(K11, a1), _mm_mul_ps(K12, a2)));
+    __m128 b2 = _mm_sub_ps(_mm_sub_ps(vn2, p2.bias), _mm_add_ps(_mm_mul_ps(K12, a1), _mm_mul_ps(K22, a2)));
+
+    // both
+    __m128 both1 = _mm_xor_ps(_mm_add_ps(_mm_mul_ps(M11, b1), _mm_mul_ps(M12, b2)), signBit);
+    __m128 both2 = _mm_xor_ps(_mm_add_ps(_mm_mul_ps(M12, b1), _mm_mul_ps(M22, b2)), signBit);
+    __m128 fitBoth = _mm_and_ps(_mm_cmpge_ps(both1, zero), _mm_cmpge_ps(both2, zero));
+    // first only
+    __m128 first1 = _mm_mul_ps(_mm_xor_ps(b1, signBit), p1.nMass);
+    __m128 fitFirst = _mm_and_ps(_mm_cmpge_ps(first1, zero), _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(K12, first1), b2), zero));
+    // second only
+    __m128 second2 = _mm_mul_ps(_mm_xor_ps(b2, signBit), p2.nMass);
+    __m128 fitSecond = _mm_and_ps(_mm_cmpge_ps(second2, zero), _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(K12, second2), b1), zero));
+    // neither
+    __m128 fitNone = _mm_and_ps(_mm_cmpge_ps(b1, zero), _mm_cmpge_ps(b2, zero));
+
+    __m128 x1 = Select(fitNone, zero, a1);
+    __m128 x2 = Select(fitNone, zero, a2);
+    x1 = Select(fitSecond, zero, x1);
+    x2 = Select(fitSecond, second2, x2);
+    x1 = Select(fitFirst, first1, x1);
+    x2 = Select(fitFirst, zero, x2);
+    x1 = Select(fitBoth, both1, x1);
+    x2 = Select(fitBoth, both2, x2);
+
+    __m128 d1 = _mm_sub_ps(x1, a1), d2 = _mm_sub_ps(x2, a2);
+    b.Apply(p1.rAx, p1.rAy, p1.rBx, p1.rBy, _mm_mul_ps(ax.Nx, d1), _mm_mul_ps(ax.Ny, d1));
+    b.Apply(p2.rAx, p2.rAy, p2.rBx, p2.rBy, _mm_mul_ps(ax.Nx, d2), _mm_mul_ps(ax.Ny, d2));
+    p1.jn = x1;
+    p2.jn = x2;
+
+    p1.Store(c, 0);
+    p2.Store(c, 1);
+    b.Store(bodies, c);
+}
+
+#endif // SIMD_X86
+
+// ------------------------------------------------------------
+// Graph-colored island
+
+void ContactSolver::SolveIslandColored(BodyStore& bodies, int begin, int end, JobSystem* jobs) {
+    // (1) greedy coloring in manifold order: lowest color neither dynamic
+    // body has used yet. Static bodies don't count, they are never written.
+    for (int k = begin; k < end; ++k) {
+        const ContactConstraint& c = constraints[k];
+        if (c.invMassA > 0.0f) bodyColors[c.a] = 0;
+        if (c.invMassB > 0.0f) bodyColors[c.b] = 0;
+    }
+    for (int k = begin; k < end; ++k) {
+        ContactConstraint& c = constraints[k];
+        uint64_t used = 0;
+        if (c.invMassA > 0.0f) used |= bodyColors[c.a];
+        if (c.invMassB > 0.0f) used |= bodyColors[c.b];
+
+        int color = 0;
+        while (color < MAX_GRAPH_COLORS && (used & (1ull << color))) ++color;
+        c.color = color;   // MAX_GRAPH_COLORS = overflow
+        if (color == MAX_GRAPH_COLORS) continue;
+
+        if (c.invMassA > 0.0f) bodyColors[c.a] |= 1ull << color;
+        if (c.invMassB > 0.0f) bodyColors[c.b] |= 1ull << color;
+    }
+
+    // Inside a color, one-point rows come first so the SIMD batches see a
+    // single kind of row. Rows of a color are independent, so their order
+    // doesn't change the result.
+    stable_sort(constraints.begin() + begin, constraints.begin() + end, [](const ContactConstraint& l, const ContactConstraint& r) {
+        if (l.color != r.color) return l.color < r.color;
+        return (l.color < MAX_GRAPH_COLORS) && l.pointCount < r.pointCount;
+    });
+
+    colorRanges.clear();
+    int overflowBegin = end;
+    for (int k = begin; k < end; ++k) {
+        if (constraints[k].color == MAX_GRAPH_COLORS) {
+            overflowBegin = k;
+            break;
+        }
+        if (k == begin || constraints[k].color != constraints[k - 1].color) colorRanges.push_back({ k, k });
+        colorRanges.back().end = k + 1;
+    }
+    colorCount = max(colorCount, (int)colorRanges.size());
+    overflowRows += end - overflowBegin;
+
+    // (2) warm start (cheap, once per step)
+    if (warmStarting) {
+        for (int k = begin; k < end; ++k) WarmStartRow(bodies, constraints[k]);
+    }
+
+    // (3) every pass walks the colors in order; rows of one color are split
+    // into fixed-size jobs, then batched 4 wide inside a job
+#if SIMD_X86
+    const bool wide = (GetSimdLevel() >= SIMD_SSE2);
+#endif
+    const int grain = max(4, rowsPerJob & ~3);
+
+    auto velocityRows = [&](int first, int last) {
+        int k = first;
+#if SIMD_X86
+        if (wide) {
+            while (k + 4 <= last) {
+                ContactConstraint* batch = &constraints[k];
+                if (batch[0].pointCount != batch[3].pointCount) {
+                    SolveVelocityRow(bodies, batch[0]);   // straddles the 1 -> 2 point boundary
+                    ++k;
+                    continue;
+                }
+                if (batch[0].pointCount == 1) SolveVelocityRows4(bodies, batch);
+                else                          SolveVelocityBlocks4(bodies, batch);
+                k += 4;
+            }
+        }
+#endif
+        for (; k < last; ++k) SolveVelocityRow(bodies, constraints[k]);
+    };
+    auto forEachColor = [&](const JobSystem::RangeFn& rows) {
+        for (const IslandRange& color : colorRanges) {
+            const int base = color.begin;
+            const int count = color.end - color.begin;
+            auto shifted = [&](int first, int last) { rows(base + first, base + last); };
+            if (jobs) jobs->ParallelFor(count, grain, shifted);
+            else      shifted(0, count);
+        }
+    };
+
+    // the overflow color may share bodies with itself: one row at a time, in order
+    for (int it = 0; it < velocityIterations; ++it) {
+        forEachColor(velocityRows);
+        for (int k = overflowBegin; k < end; ++k) SolveVelocityRow(bodies, constraints[k]);
+    }
+}
+
+// ------------------------------------------------------------
+
+void ContactSolver::StoreImpulses(vector<ContactManifold>& manifolds) const {
+    for (const ContactConstraint& c : constraints) {
+        ContactManifold& m = manifolds[c.manifold];
+        for (int k = 0; k < m.pointCount; ++k) {
+            ManifoldPoint& p = m.points[k];
+            p.normalImpulse = (k < c.pointCount) ? c.points[k].normalImpulse : 0.0f;
+            p.tangentImpulse = (k < c.pointCount) ? c.points[k].tangentImpulse : 0.0f;
+        }
+    }
+}
+
+void ContactSolver::Solve(BodyStore& bodies, vector<ContactManifold>& manifolds,
+    const IslandManager& islands, JobSystem* jobs) {
+    Prepare(bodies, manifolds, islands);
+    bodyColors.resize(bodies.Count());
+
+    coloredIslands = 0;
+    colorCount = 0;
+    overflowRows = 0;
+
+    // (1) big islands one at a time, each spread over the threads by color
+    smallIslands.clear();
+    for (int r = 0; r < (int)islandRanges.size(); ++r) {
+        const IslandRange& range = islandRanges[r];
+        if (graphColoring && range.end - range.begin >= colorThreshold) {
+            SolveIslandColored(bodies, range.begin, range.end, jobs);
+            ++coloredIslands;
+        }
+        else {
+            smallIslands.push_back(r);
+        }
+    }
+
+    // (2) the rest are independent, so how they are spread over threads
+    // can't change the result. Several small islands go into one job.
+    const int islandCount = (int)smallIslands.size();
+    const int threads = jobs ? jobs->ThreadCount() : 1;
+    const int grain = max(1, islandCount / (threads * 4));
+    auto solveRanges = [this, &bodies](int first, int last) {
+        for (int s = first; s < last; ++s) {
+            const IslandRange& range = islandRanges[smallIslands[s]];
+            SolveIsland(bodies, range.begin, range.end);
+        }
+    };
+    if (jobs) jobs->ParallelFor(islandCount, grain, solveRanges);
+    else      solveRanges(0, islandCount);
+
+    StoreImpulses(manifolds);
+}
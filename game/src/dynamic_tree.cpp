@@ -0,0 +1,354 @@
+#include "fp_mode.h"
+#include "dynamic_tree.h"
+
+#include <algorithm>
+
+using namespace std;
+
+// ------------------------------------------------------------
+// Box helpers
+
+static inline AABB Union(const AABB& a, const AABB& b) {
+    AABB c;
+    c.min = { min(a.min.x, b.min.x), min(a.min.y, b.min.y) };
+    c.max = { max(a.max.x, b.max.x), max(a.max.y, b.max.y) };
+    return c;
+}
+
+// 2D stand-in for surface area in the insertion cost
+static inline float Perimeter(const AABB& a) {
+    return 2.0f * ((a.max.x - a.min.x) + (a.max.y - a.min.y));
+}
+
+static inline bool Contains(const AABB& outer, const AABB& inner) {
+    return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y &&
+           inner.max.x <= outer.max.x && inner.max.y <= outer.max.y;
+}
+
+static inline AABB Fatten(const AABB& a) {
+    AABB f;
+    f.min = { a.min.x - TREE_FAT_MARGIN, a.min.y - TREE_FAT_MARGIN };
+    f.max = { a.max.x + TREE_FAT_MARGIN, a.max.y + TREE_FAT_MARGIN };
+    return f;
+}
+
+// ------------------------------------------------------------
+// Node pool
+
+int DynamicTree::AllocateNode() {
+    if (freeList == -1) {
+        nodes.push_back(Node());
+        return (int)nodes.size() - 1;
+    }
+    int id = freeList;
+    freeList = nodes[id].parent;
+    nodes[id] = Node();
+    return id;
+}
+
+void DynamicTree::FreeNode(int id) {
+    nodes[id].parent = freeList;
+    nodes[id].height = -1;
+    freeList = id;
+}
+
+void DynamicTree::Clear() {
+    nodes.clear();
+    root = -1;
+    freeList = -1;
+}
+
+// ------------------------------------------------------------
+// Proxies
+
+int DynamicTree::CreateProxy(const AABB& box, int body) {
+    int leaf = AllocateNode();
+    nodes[leaf].box = Fatten(box);
+    nodes[leaf].body = body;
+    nodes[leaf].height = 0;
+    InsertLeaf(leaf);
+    return leaf;
+}
+
+void DynamicTree::DestroyProxy(int proxy) {
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+}
+
+bool DynamicTree::MoveProxy(int proxy, const AABB& box) {
+    if (Contains(nodes[proxy].box, box)) return false; // still inside the fat box
+
+    RemoveLeaf(proxy);
+    nodes[proxy].box = Fatten(box);
+    InsertLeaf(proxy);
+    return true;
+}
+
+// ------------------------------------------------------------
+// Insertion / removal
+
+void DynamicTree::InsertLeaf(int leaf) {
+    if (root == -1) {
+        root = leaf;
+        nodes[root].parent = -1;
+        return;
+    }
+
+    // walk down picking the cheaper child (perimeter heuristic)
+    AABB leafBox = nodes[leaf].box;
+    int index = root;
+    while (!nodes[index].IsLeaf()) {
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+
+        float area = Perimeter(nodes[index].box);
+        float combinedArea = Perimeter(Union(nodes[index].box, leafBox));
+
+        // cost of making a new parent for this node and the leaf
+        float cost = 2.0f * combinedArea;
+        // minimum cost of pushing the leaf further down
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float cost1 = Perimeter(Union(leafBox, nodes[child1].box)) + inheritanceCost;
+        if (!nodes[child1].IsLeaf()) cost1 -= Perimeter(nodes[child1].box);
+
+        float cost2 = Perimeter(Union(leafBox, nodes[child2].box)) + inheritanceCost;
+        if (!nodes[child2].IsLeaf()) cost2 -= Perimeter(nodes[child2].box);
+
+        if (cost < cost1 && cost < cost2) break;
+        index = (cost1 < cost2) ? child1 : child2;
+    }
+
+    // new parent joins the chosen sibling and the leaf
+    int sibling = index;
+    int oldParent = nodes[sibling].parent;
+    int newParent = AllocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].box = Union(leafBox, nodes[sibling].box);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent != -1) {
+        if (nodes[oldParent].child1 == sibling) nodes[oldParent].child1 = newParent;
+        else                                    nodes[oldParent].child2 = newParent;
+    }
+    else {
+        root = newParent;
+    }
+
+    // refit and rebalance the path back to the root
+    Refit(nodes[leaf].parent);
+}
+
+void DynamicTree::RemoveLeaf(int leaf) {
+    if (leaf == root) {
+        root = -1;
+        return;
+    }
+
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = (nodes[parent].child1 == leaf) ? nodes[parent].child2 : nodes[parent].child1;
+
+    if (grandParent != -1) {
+        // sibling takes the parent's place
+        if (nodes[grandParent].child1 == parent) nodes[grandParent].child1 = sibling;
+        else                                     nodes[grandParent].child2 = sibling;
+        nodes[sibling].parent = grandParent;
+        FreeNode(parent);
+        Refit(grandParent);
+    }
+    else {
+        root = sibling;
+        nodes[sibling].parent = -1;
+        FreeNode(parent);
+    }
+}
+
+void DynamicTree::Refit(int id) {
+    while (id != -1) {
+        id = Balance(id);
+
+        int child1 = nodes[id].child1;
+        int child2 = nodes[id].child2;
+        nodes[id].height = 1 + max(nodes[child1].height, nodes[child2].height);
+        nodes[id].box = Union(nodes[child1].box, nodes[child2].box);
+
+        id = nodes[id].parent;
+    }
+}
+
+// Tree rotation when one child is more than one level taller than the other.
+// Returns the node now sitting where iA was.
+int DynamicTree::Balance(int iA) {
+    Node& A = nodes[iA];
+    if (A.IsLeaf() || A.height < 2) return iA;
+
+    int iB = A.child1;
+    int iC = A.child2;
+    Node& B = nodes[iB];
+    Node& C = nodes[iC];
+
+    int balance = C.height - B.height;
+
+    // rotate C up
+    if (balance > 1) {
+        int iF = C.child1;
+        int iG = C.child2;
+        Node& F = nodes[iF];
+        Node& G = nodes[iG];
+
+        C.child1 = iA;
+        C.parent = A.parent;
+        A.parent = iC;
+
+        if (C.parent != -1) {
+            if (nodes[C.parent].child1 == iA) nodes[C.parent].child1 = iC;
+            else                              nodes[C.parent].child2 = iC;
+        }
+        else {
+            root = iC;
+        }
+
+        if (F.height > G.height) {
+            C.child2 = iF;
+            A.child2 = iG;
+            G.parent = iA;
+            A.box = Union(B.box, G.box);
+            C.box = Union(A.box, F.box);
+            A.height = 1 + max(B.height, G.height);
+            C.height = 1 + max(A.height, F.height);
+        }
+        else {
+            C.child2 = iG;
+            A.child2 = iF;
+            F.parent = iA;
+            A.box = Union(B.box, F.box);
+            C.box = Union(A.box, G.box);
+            A.height = 1 + max(B.height, F.height);
+            C.height = 1 + max(A.height, G.height);
+        }
+        return iC;
+    }
+
+    // rotate B up
+    if (balance < -1) {
+        int iD = B.child1;
+        int iE = B.child2;
+        Node& D = nodes[iD];
+        Node& E = nodes[iE];
+
+        B.child1 = iA;
+        B.parent = A.parent;
+        A.parent = iB;
+
+        if (B.parent != -1) {
+            if (nodes[B.parent].child1 == iA) nodes[B.parent].child1 = iB;
+            else                              nodes[B.parent].child2 = iB;
+        }
+        else {
+            root = iB;
+        }
+
+        if (D.height > E.height) {
+            B.child2 = iD;
+            A.child1 = iE;
+            E.parent = iA;
+            A.box = Union(C.box, E.box);
+            B.box = Union(A.box, D.box);
+            A.height = 1 + max(C.height, E.height);
+            B.height = 1 + max(A.height, D.height);
+        }
+        else {
+            B.child2 = iE;
+            A.child1 = iD;
+            D.parent = iA;
+            A.box = Union(C.box, D.box);
+            B.box = Union(A.box, E.box);
+            A.height = 1 + max(C.height, D.height);
+            B.height = 1 + max(A.height, E.height);
+        }
+        return iB;
+    }
+
+    return iA;
+}
+
+// ------------------------------------------------------------
+// Tree broadphase
+
+void TreeBroadphase::FindPairs(const vector<BroadphaseProxy>& proxies, vector<BodyPair>& pairs) {
+    int maxBody = -1;
+    for (const BroadphaseProxy& p : proxies) maxBody = max(maxBody, p.body);
+
+    if ((int)leafOfBody.size() < maxBody + 1) leafOfBody.resize(maxBody + 1, -1);
+    proxyOfBody.assign(leafOfBody.size(), -1);
+    tightBox.resize(leafOfBody.size());
+    for (int i = 0; i < (int)proxies.size(); ++i) proxyOfBody[proxies[i].body] = i;
+
+    // (1) bodies that went inactive lose their leaf
+    for (size_t b = 0; b < leafOfBody.size(); ++b) {
+        if (leafOfBody[b] != -1 && proxyOfBody[b] < 0) {
+            tree.DestroyProxy(leafOfBody[b]);
+            leafOfBody[b] = -1;
+        }
+    }
+
+    // (2) sync leaves; only bodies that left their fat box get reinserted
+    reinsertCount = 0;
+    for (const BroadphaseProxy& p : proxies) {
+        int& leaf = leafOfBody[p.body];
+        if (leaf == -1) {
+            leaf = tree.CreateProxy(p.box, p.body);
+            ++reinsertCount;
+        }
+        else if (tree.MoveProxy(leaf, p.box)) {
+            ++reinsertCount;
+        }
+        tightBox[p.body] = p.box;
+    }
+    leafCount = (int)proxies.size();
+
+    // (3) dynamic bodies query the tree. Dynamic-dynamic pairs are kept by
+    // the lower index, static partners are never the ones asking.
+    size_t first = pairs.size();
+    for (const BroadphaseProxy& p : proxies) {
+        if (p.isStatic) continue;
+        tree.Query(p.box, [&](int leaf) {
+            int other = tree.BodyOf(leaf);
+            if (other == p.body) return;
+            const BroadphaseProxy& q = proxies[proxyOfBody[other]];
+            if (!q.isStatic && other < p.body) return;
+            AddCandidatePair(p, q, pairs);
+        });
+    }
+
+    sort(pairs.begin() + first, pairs.end());
+}
+
+void TreeBroadphase::Remap(const vector<int>& newIndex) {
+    vector<int> leaves(leafOfBody.size(), -1);
+    for (size_t b = 0; b < leafOfBody.size(); ++b) {
+        int leaf = leafOfBody[b];
+        if (leaf == -1) continue;
+        int to = (b < newIndex.size()) ? newIndex[b] : -1;
+        if (to < 0) {
+            tree.DestroyProxy(leaf);
+            continue;
+        }
+        leaves[to] = leaf;
+        tightBox[to] = tightBox[b];   // to <= b, so this never overwrites a box still to be moved
+        tree.SetBody(leaf, to);
+    }
+    leafOfBody.swap(leaves);
+}
+
+void TreeBroadphase::Query(const AABB& region, vector<int>& out) const {
+    tree.Query(region, [&](int leaf) {
+        int body = tree.BodyOf(leaf);
+        if (AABBOverlaps(tightBox[body], region)) out.push_back(body);
+    });
+}
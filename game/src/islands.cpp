@@ -0,0 +1,99 @@
+#include "fp_mode.h"
+#include "islands.h"
+
+#include <algorithm>
+
+using namespace std;
+
+static inline bool IsDynamic(const BodyStore& bodies, int i) {
+    return bodies.active[i] && bodies.invMass[i] > 0.0f;
+}
+
+int IslandManager::Find(int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];   // path halving
+        i = parent[i];
+    }
+    return i;
+}
+
+void IslandManager::Union(int a, int b) {
+    a = Find(a);
+    b = Find(b);
+    if (a == b) return;
+    if (a < b) parent[b] = a;
+    else       parent[a] = b;
+}
+
+void IslandManager::WakeBody(BodyStore& bodies, int i) {
+    if (!bodies.active[i]) return;
+    bodies.awake[i] = 1;
+    bodies.sleepTime[i] = 0.0f;
+}
+
+void IslandManager::WakeAll(BodyStore& bodies) {
+    for (int i = 0; i < bodies.Count(); ++i) WakeBody(bodies, i);
+}
+
+void IslandManager::Build(BodyStore& bodies, const vector<ContactManifold>& manifolds) {
+    const int n = bodies.Count();
+    parent.resize(n);
+    for (int i = 0; i < n; ++i) parent[i] = i;
+
+    // (1) union over contacts between two dynamic bodies
+    for (const ContactManifold& m : manifolds) {
+        if (IsDynamic(bodies, m.a) && IsDynamic(bodies, m.b)) Union(m.a, m.b);
+    }
+
+    // (2) flatten, then an island is awake if any of its bodies is
+    islandAwake.assign(n, 0);
+    for (int i = 0; i < n; ++i) {
+        parent[i] = Find(i);
+        if (IsDynamic(bodies, i) && bodies.awake[i]) islandAwake[parent[i]] = 1;
+    }
+
+    // (3) wake on contact: sleepers in an awake island join in this step
+    islandCount = 0;
+    wokenCount = 0;
+    for (int i = 0; i < n; ++i) {
+        if (!IsDynamic(bodies, i)) continue;
+        int root = parent[i];
+        if (root == i && islandAwake[i]) ++islandCount;
+        if (!bodies.awake[i] && islandAwake[root]) {
+            WakeBody(bodies, i);
+            ++wokenCount;
+        }
+    }
+}
+
+void IslandManager::UpdateSleep(BodyStore& bodies, float dt) {
+    const int n = bodies.Count();
+    const float speedSq = sleepSpeed * sleepSpeed;
+
+    // (1) per-body rest timers, folded into a per-island minimum
+    islandRest.assign(n, 1e30f);
+    for (int i = 0; i < n; ++i) {
+        if (!IsDynamic(bodies, i) || !bodies.awake[i]) continue;
+
+        // spin counts as the speed of the body's outermost point
+        float spin = bodies.angularVelocity[i] * bodies.shape[i].radius;
+        bool moving = Vector2LengthSqr(bodies.velocity[i]) > speedSq || spin * spin > speedSq;
+        if (!sleepEnabled || moving) bodies.sleepTime[i] = 0.0f;
+        else                         bodies.sleepTime[i] += dt;
+
+        int root = parent[i];
+        islandRest[root] = min(islandRest[root], bodies.sleepTime[i]);
+    }
+
+    // (2) islands that have all rested long enough go to sleep together
+    sleepingCount = 0;
+    for (int i = 0; i < n; ++i) {
+        if (!IsDynamic(bodies, i)) continue;
+        if (bodies.awake[i] && islandRest[parent[i]] >= timeToSleep) {
+            bodies.awake[i] = 0;
+            bodies.velocity[i] = { 0.0f, 0.0f };
+            bodies.angularVelocity[i] = 0.0f;
+        }
+        if (!bodies.awake[i]) ++sleepingCount;
+    }
+}
@@ -0,0 +1,116 @@
+#include "job_system.h"
+
+#include <algorithm>
+
+using namespace std;
+
+void JobSystem::Start(int threadCount) {
+    Stop();
+
+    if (threadCount <= 0) threadCount = (int)thread::hardware_concurrency();
+    threadCount = max(threadCount, 1);
+
+    quit = false;
+    for (int i = 0; i < threadCount; ++i) queues.push_back(make_unique<Queue>());
+    for (int i = 1; i < threadCount; ++i) workers.emplace_back(&JobSystem::WorkerMain, this, i);
+}
+
+void JobSystem::Stop() {
+    {
+        lock_guard<mutex> lock(sleepMutex);
+        quit = true;
+    }
+    sleepCv.notify_all();
+    for (thread& t : workers) t.join();
+    workers.clear();
+    queues.clear();
+}
+
+bool JobSystem::TakeJob(int self, Job& job) {
+    const int n = (int)queues.size();
+
+    // own queue first, newest job (still warm in cache)
+    {
+        Queue& q = *queues[self];
+        lock_guard<mutex> lock(q.mutex);
+        if (!q.jobs.empty()) {
+            job = q.jobs.back();
+            q.jobs.pop_back();
+            --queued;
+            return true;
+        }
+    }
+
+    // steal the oldest job from the next queue that has one
+    for (int k = 1; k < n; ++k) {
+        Queue& q = *queues[(self + k) % n];
+        lock_guard<mutex> lock(q.mutex);
+        if (!q.jobs.empty()) {
+            job = q.jobs.front();
+            q.jobs.pop_front();
+            --queued;
+            ++jobsStolen;
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::RunJob(const Job& job) {
+    (*job.fn)(job.begin, job.end);
+    ++jobsRun;
+    job.pending->fetch_sub(1, memory_order_release);
+}
+
+void JobSystem::WorkerMain(int self) {
+    for (;;) {
+        Job job;
+        if (TakeJob(self, job)) {
+            RunJob(job);
+            continue;
+        }
+
+        unique_lock<mutex> lock(sleepMutex);
+        sleepCv.wait(lock, [this] { return quit || queued.load() > 0; });
+        if (quit) return;
+    }
+}
+
+void JobSystem::ParallelFor(int count, int grain, const RangeFn& fn) {
+    if (count <= 0) return;
+    grain = max(grain, 1);
+    const int chunks = (count + grain - 1) / grain;
+
+    // nothing to share: run the chunks in order on this thread
+    if (workers.empty() || chunks == 1) {
+        for (int begin = 0; begin < count; begin += grain) fn(begin, min(begin + grain, count));
+        return;
+    }
+
+    // deal the chunks out round-robin; stealing evens out the rest
+    atomic<int> pending(chunks);
+    const int n = (int)queues.size();
+    for (int c = 0; c < chunks; ++c) {
+        Job job;
+        job.fn = &fn;
+        job.begin = c * grain;
+        job.end = min(job.begin + grain, count);
+        job.pending = &pending;
+
+        Queue& q = *queues[c % n];
+        lock_guard<mutex> lock(q.mutex);
+        q.jobs.push_back(job);
+    }
+    {
+        lock_guard<mutex> lock(sleepMutex);
+        queued += chunks;
+    }
+    sleepCv.notify_all();
+
+    // help until every chunk has finished
+    while (pending.load(memory_order_acquire) > 0) {
+        Job job;
+        if (TakeJob(0, job)) RunJob(job);
+        else                 this_thread::yield();
+    }
+}
@@ -0,0 +1,466 @@
+#include "fp_mode.h"
+#include "level.h"
+#include "mapped_file.h"
+#include "simulation.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+using namespace std;
+
+static_assert(is_trivially_copyable<BodyShape>::value && is_trivially_copyable<BodyMaterial>::value &&
+    is_trivially_copyable<BodyGameData>::value && is_trivially_copyable<ConvexPolygon>::value &&
+    is_trivially_copyable<TerrainChain>::value,
+    "level sections are raw copies of the body and terrain arrays");
+
+enum LevelSection {
+    SECTION_POSITION,
+    SECTION_ROTATION,
+    SECTION_VELOCITY,
+    SECTION_ANGULAR_VELOCITY,
+    SECTION_INV_MASS,
+    SECTION_INV_INERTIA,
+    SECTION_ACTIVE,
+    SECTION_SHAPE,
+    SECTION_MATERIAL,
+    SECTION_GAME,
+    SECTION_POLYGONS,       // polygonCount elements
+    SECTION_CHAIN_POINTS,   // pointCount elements
+    SECTION_CHAINS,         // chainCount elements, the rest bodyCount
+    SECTION_COUNT
+};
+
+struct LevelHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t bodyCount;
+    uint32_t polygonCount;
+    uint32_t pointCount;
+    uint32_t chainCount;
+    float    worldWidth;
+    uint32_t elementSize[SECTION_COUNT];
+    uint64_t offset[SECTION_COUNT];
+};
+
+static const uint32_t elementSizes[SECTION_COUNT] = {
+    sizeof(Vector2), sizeof(Vector2), sizeof(Vector2), sizeof(float), sizeof(float), sizeof(float),
+    sizeof(uint8_t), sizeof(BodyShape), sizeof(BodyMaterial), sizeof(BodyGameData), sizeof(ConvexPolygon),
+    sizeof(Vector2), sizeof(TerrainChain)
+};
+
+static inline uint64_t SectionElements(int s, const LevelHeader& h) {
+    switch (s) {
+    case SECTION_POLYGONS:     return h.polygonCount;
+    case SECTION_CHAIN_POINTS: return h.pointCount;
+    case SECTION_CHAINS:       return h.chainCount;
+    default:                   return h.bodyCount;
+    }
+}
+
+// A level's bodies and terrain, wherever they live (a mapped file, a LevelData)
+struct LevelView {
+    float               worldWidth = 0.0f;
+    BodyArrays          bodies;
+    int                 pointCount = 0;
+    const Vector2*      points = nullptr;
+    int                 chainCount = 0;
+    const TerrainChain* chains = nullptr;
+};
+
+static inline uint64_t AlignUp(uint64_t x) {
+    return (x + 15) & ~(uint64_t)15;
+}
+
+// ------------------------------------------------------------
+// Text -> bodies
+
+struct NamedColor {
+    const char* name;
+    Color       color;
+};
+
+static const NamedColor namedColors[] = {
+    { "lightgray", LIGHTGRAY }, { "gray", GRAY },   { "darkgray", DARKGRAY },
+    { "yellow", YELLOW },       { "gold", GOLD },   { "orange", ORANGE },
+    { "red", RED },             { "maroon", MAROON }, { "green", GREEN },
+    { "lime", LIME },           { "darkgreen", DARKGREEN }, { "skyblue", SKYBLUE },
+    { "blue", BLUE },           { "darkblue", DARKBLUE }, { "purple", PURPLE },
+    { "violet", VIOLET },       { "beige", BEIGE }, { "brown", BROWN },
+    { "darkbrown", DARKBROWN }, { "white", WHITE },
+};
+
+static bool ParseColor(const char* s, Color& out) {
+    unsigned int rgb;
+    if (s[0] == '#' && strlen(s) == 7 && sscanf(s + 1, "%x", &rgb) == 1) {
+        out = { (unsigned char)(rgb >> 16), (unsigned char)(rgb >> 8), (unsigned char)rgb, 255 };
+        return true;
+    }
+    for (const NamedColor& c : namedColors) {
+        if (strcmp(c.name, s) == 0) {
+            out = c.color;
+            return true;
+        }
+    }
+    return false;
+}
+
+// The numbers after the command, up to an optional trailing color
+static bool ParseNumberList(const string& line, vector<float>& nums, Color& color) {
+    nums.clear();
+    bool hasColor = false;
+    int used = 0;
+    const char* q = line.c_str();
+    sscanf(q, " %*s%n", &used);
+    q += used;
+    char token[32];
+    while (sscanf(q, " %31s%n", token, &used) == 1) {
+        q += used;
+        char* rest = nullptr;
+        float f = strtof(token, &rest);
+        if (!hasColor && rest != token && *rest == '\0') nums.push_back(f);
+        else if (!hasColor && ParseColor(token, color)) hasColor = true;
+        else return false;
+    }
+    return true;
+}
+
+bool CompileLevelText(const char* text, const char* name, LevelData& out) {
+    out.worldWidth = 0.0f;
+    out.bodies.Clear();
+    out.terrain.Clear();
+    vector<float> nums;
+    vector<Vector2> chainPoints;
+
+    // material for the bodies that follow (set ...)
+    float restitution = globalRestitution;
+    float friction = globalFrictionCoeff;
+    float toughness = pigToughness;
+    float angle = 0.0f;   // radians
+
+    // pending grid (applies to the next body line)
+    int gridCols = 1, gridRows = 1;
+    Vector2 gridStep{ 0.0f, 0.0f };
+
+    int lineNo = 0;
+    const char* p = text;
+    while (*p) {
+        const char* end = strchr(p, '\n');
+        if (!end) end = p + strlen(p);
+        string line(p, end);
+        p = *end ? end + 1 : end;
+        ++lineNo;
+
+        size_t hash = line.find('#');
+        if (hash != string::npos) line.resize(hash);
+
+        char cmd[16] = "", arg[32] = "";
+        if (sscanf(line.c_str(), " %15s", cmd) != 1) continue;   // blank line
+
+        float v[5] = {};
+        int n = sscanf(line.c_str(), " %*s %f %f %f %f %f", &v[0], &v[1], &v[2], &v[3], &v[4]);
+        bool ok = true;
+        Body b;
+
+        if (strcmp(cmd, "world") == 0) {
+            if (n != 1) {
+                fprintf(stderr, "%s:%d: expected \"world width\"\n", name, lineNo);
+                return false;
+            }
+            out.worldWidth = max(out.worldWidth, v[0]);
+            continue;
+        }
+        else if (strcmp(cmd, "set") == 0) {
+            ok = (sscanf(line.c_str(), " %*s %31s %f", arg, &v[0]) == 2);
+            if (ok && strcmp(arg, "restitution") == 0)    restitution = v[0];
+            else if (ok && strcmp(arg, "friction") == 0)  friction = v[0];
+            else if (ok && strcmp(arg, "toughness") == 0) toughness = v[0];
+            else if (ok && strcmp(arg, "angle") == 0)     angle = v[0] * DEG2RAD;
+            else ok = false;
+            if (!ok) {
+                fprintf(stderr, "%s:%d: expected \"set restitution|friction|toughness|angle value\"\n", name, lineNo);
+                return false;
+            }
+            continue;
+        }
+        else if (strcmp(cmd, "grid") == 0) {
+            ok = (n == 4 && v[0] >= 1.0f && v[1] >= 1.0f);
+            gridCols = (int)v[0];
+            gridRows = (int)v[1];
+            gridStep = { v[2], v[3] };
+            if (!ok) {
+                fprintf(stderr, "%s:%d: expected \"grid cols rows dx dy\"\n", name, lineNo);
+                return false;
+            }
+            continue;
+        }
+        else if (strcmp(cmd, "block") == 0) {
+            ok = (n == 5);
+            b = MakeBox(OBJ_BLOCK, { v[0], v[1] }, { v[2], v[3] }, v[4], BROWN, angle);
+            if (sscanf(line.c_str(), " %*s %*f %*f %*f %*f %*f %31s", arg) == 1) ok = ok && ParseColor(arg, b.color);
+        }
+        else if (strcmp(cmd, "poly") == 0) {
+            Color color = BROWN;
+            ok = ParseNumberList(line, nums, color);
+            int count = (int)nums.size();
+            ok = ok && count >= 9 && (count - 3) % 2 == 0 && (count - 3) / 2 <= MAX_POLYGON_VERTICES;
+            if (ok) {
+                Vector2 points[MAX_POLYGON_VERTICES];
+                int pointCount = (count - 3) / 2;
+                for (int k = 0; k < pointCount; ++k) points[k] = { nums[3 + 2 * k], nums[4 + 2 * k] };
+                b = MakePolygon(OBJ_BLOCK, { nums[0], nums[1] }, points, pointCount, nums[2], color, angle);
+            }
+        }
+        else if (strcmp(cmd, "ball") == 0) {
+            ok = (n == 4);
+            b = MakeCircle(OBJ_BLOCK, { v[0], v[1] }, v[2], v[3], LIGHTGRAY);
+            if (sscanf(line.c_str(), " %*s %*f %*f %*f %*f %31s", arg) == 1) ok = ok && ParseColor(arg, b.color);
+        }
+        else if (strcmp(cmd, "pig") == 0) {
+            ok = (n == 4);
+            b = MakeCircle(OBJ_PIG, { v[0], v[1] }, v[2], v[3], GREEN);
+        }
+        else if (strcmp(cmd, "chain") == 0) {
+            Color color = DARKGREEN;
+            ok = ParseNumberList(line, nums, color) && nums.size() >= 4 && nums.size() % 2 == 0 &&
+                gridCols * gridRows == 1;   // one body per chain
+            chainPoints.clear();
+            for (size_t k = 0; ok && k < nums.size(); k += 2) chainPoints.push_back({ nums[k], nums[k + 1] });
+            int chain = ok ? out.terrain.AddChain(chainPoints.data(), (int)chainPoints.size()) : -1;
+            ok = ok && chain >= 0;
+            if (ok) b = MakeChain(out.terrain, chain, color);
+        }
+        else if (strcmp(cmd, "wall") == 0) {
+            ok = (n == 4);
+            b = MakeAABB(OBJ_STATIC_TERRAIN, { v[0], v[1] }, { v[2], v[3] }, 0.0f, DARKGRAY);
+            if (sscanf(line.c_str(), " %*s %*f %*f %*f %*f %31s", arg) == 1) ok = ok && ParseColor(arg, b.color);
+        }
+        else {
+            fprintf(stderr, "%s:%d: unknown command '%s'\n", name, lineNo, cmd);
+            return false;
+        }
+
+        if (!ok || (b.shape == SHAPE_CIRCLE ? b.radius <= 0.0f :
+                (b.shape != SHAPE_CHAIN && (b.halfExtents.x <= 0.0f || b.halfExtents.y <= 0.0f))) ||
+            (b.shape == SHAPE_POLYGON && b.polygon.count < 3)) {
+            fprintf(stderr, "%s:%d: bad '%s' (see level.h for the arguments)\n", name, lineNo, cmd);
+            return false;
+        }
+
+        if (b.invMass > 0.0f) {
+            b.restitution = restitution;
+            b.friction = friction;
+        }
+        if (b.type == OBJ_PIG) b.toughness = toughness;
+
+        Vector2 origin = b.position;
+        for (int row = 0; row < gridRows; ++row) {
+            for (int col = 0; col < gridCols; ++col) {
+                b.position = { origin.x + col * gridStep.x, origin.y + row * gridStep.y };
+                out.bodies.Add(b);
+            }
+        }
+        gridCols = gridRows = 1;
+    }
+    return true;
+}
+
+// ------------------------------------------------------------
+// Binary files
+
+bool SaveLevel(const char* path, float levelWidth, const BodyArrays& src, const Terrain& terrain) {
+    const void* sections[SECTION_COUNT] = {
+        src.position, src.rotation, src.velocity, src.angularVelocity, src.invMass, src.invInertia,
+        src.active, src.shape, src.material, src.game, src.polygons, terrain.points.data(), terrain.chains.data()
+    };
+
+    LevelHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = LEVEL_MAGIC;
+    h.version = LEVEL_VERSION;
+    h.headerSize = (uint16_t)sizeof(LevelHeader);
+    h.bodyCount = (uint32_t)src.count;
+    h.polygonCount = (uint32_t)src.polygonCount;
+    h.pointCount = (uint32_t)terrain.points.size();
+    h.chainCount = (uint32_t)terrain.chains.size();
+    h.worldWidth = levelWidth;
+
+    uint64_t at = AlignUp(sizeof(LevelHeader));
+    for (int s = 0; s < SECTION_COUNT; ++s) {
+        h.elementSize[s] = elementSizes[s];
+        h.offset[s] = at;
+        at = AlignUp(at + elementSizes[s] * SectionElements(s, h));
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+
+    static const uint8_t zeros[16] = {};
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    uint64_t written = sizeof(h);
+    for (int s = 0; s < SECTION_COUNT && ok; ++s) {
+        ok = fwrite(zeros, 1, (size_t)(h.offset[s] - written), f) == h.offset[s] - written;
+        size_t bytes = (size_t)(elementSizes[s] * SectionElements(s, h));
+        ok = ok && (bytes == 0 || fwrite(sections[s], 1, bytes, f) == bytes);
+        written = h.offset[s] + bytes;
+    }
+    ok = (fclose(f) == 0) && ok;
+    return ok;
+}
+
+bool CompileLevelFile(const char* textPath, const char* levelPath) {
+    MappedFile file;
+    if (!file.Open(textPath)) {
+        fprintf(stderr, "%s: can't open\n", textPath);
+        return false;
+    }
+
+    LevelData level;
+    string text((const char*)file.data, file.size);
+    if (!CompileLevelText(text.c_str(), textPath, level)) return false;
+    if (!SaveLevel(levelPath, level.worldWidth, level.bodies.View(), level.terrain)) {
+        fprintf(stderr, "%s: can't write\n", levelPath);
+        return false;
+    }
+    return true;
+}
+
+// Checks the header and section bounds; fills in a view into the mapping
+static bool MapLevel(const MappedFile& file, const char* path, LevelView& out) {
+    LevelHeader h;
+    if (file.size < sizeof(h)) {
+        fprintf(stderr, "%s: truncated level file\n", path);
+        return false;
+    }
+    memcpy(&h, file.data, sizeof(h));
+    if (h.version != LEVEL_VERSION || h.headerSize != sizeof(LevelHeader)) {
+        fprintf(stderr, "%s: level version %u, this build reads %u\n", path, h.version, LEVEL_VERSION);
+        return false;
+    }
+
+    const void* sections[SECTION_COUNT];
+    for (int s = 0; s < SECTION_COUNT; ++s) {
+        if (h.elementSize[s] != elementSizes[s]) {
+            fprintf(stderr, "%s: written by a build with a different body layout; compile it again\n", path);
+            return false;
+        }
+        uint64_t bytes = h.elementSize[s] * SectionElements(s, h);
+        if (h.offset[s] % 16 != 0 || h.offset[s] > file.size || bytes > file.size - h.offset[s]) {
+            fprintf(stderr, "%s: truncated level file\n", path);
+            return false;
+        }
+        sections[s] = file.data + h.offset[s];
+    }
+
+    // polygons go straight to the narrowphase, which trusts their vertex count
+    const ConvexPolygon* polygons = (const ConvexPolygon*)sections[SECTION_POLYGONS];
+    for (uint32_t p = 0; p < h.polygonCount; ++p) {
+        if (polygons[p].count < 3 || polygons[p].count > MAX_POLYGON_VERTICES) {
+            fprintf(stderr, "%s: polygon %u has %i vertices\n", path, p, polygons[p].count);
+            return false;
+        }
+    }
+
+    // cross-references: polygon and chain shapes index their pools, chains the points
+    const BodyShape* shapes = (const BodyShape*)sections[SECTION_SHAPE];
+    for (uint32_t i = 0; i < h.bodyCount; ++i) {
+        if ((unsigned)shapes[i].type > SHAPE_CHAIN) {
+            fprintf(stderr, "%s: body %u has an unknown shape\n", path, i);
+            return false;
+        }
+        if (shapes[i].type == SHAPE_POLYGON && (shapes[i].polygon < 0 || (uint32_t)shapes[i].polygon >= h.polygonCount)) {
+            fprintf(stderr, "%s: body %u has no polygon\n", path, i);
+            return false;
+        }
+        if (shapes[i].type == SHAPE_CHAIN && (shapes[i].chain < 0 || (uint32_t)shapes[i].chain >= h.chainCount)) {
+            fprintf(stderr, "%s: body %u has no chain\n", path, i);
+            return false;
+        }
+    }
+    const TerrainChain* chains = (const TerrainChain*)sections[SECTION_CHAINS];
+    for (uint32_t c = 0; c < h.chainCount; ++c) {
+        if (chains[c].first < 0 || chains[c].count < 2 || (uint32_t)chains[c].first > h.pointCount ||
+            (uint32_t)chains[c].count > h.pointCount - (uint32_t)chains[c].first) {
+            fprintf(stderr, "%s: chain %u is out of bounds\n", path, c);
+            return false;
+        }
+    }
+
+    BodyArrays& b = out.bodies;
+    out.worldWidth = h.worldWidth;
+    b.count = (int)h.bodyCount;
+    b.position = (const Vector2*)sections[SECTION_POSITION];
+    b.rotation = (const Vector2*)sections[SECTION_ROTATION];
+    b.velocity = (const Vector2*)sections[SECTION_VELOCITY];
+    b.angularVelocity = (const float*)sections[SECTION_ANGULAR_VELOCITY];
+    b.invMass = (const float*)sections[SECTION_INV_MASS];
+    b.invInertia = (const float*)sections[SECTION_INV_INERTIA];
+    b.active = (const uint8_t*)sections[SECTION_ACTIVE];
+    b.shape = shapes;
+    b.material = (const BodyMaterial*)sections[SECTION_MATERIAL];
+    b.game = (const BodyGameData*)sections[SECTION_GAME];
+    b.polygonCount = (int)h.polygonCount;
+    b.polygons = polygons;
+    out.pointCount = (int)h.pointCount;
+    out.points = (const Vector2*)sections[SECTION_CHAIN_POINTS];
+    out.chainCount = (int)h.chainCount;
+    out.chains = chains;
+    return true;
+}
+
+// Ground sized for the level, the level's terrain (BVH built here, once),
+// then its bodies in one bulk copy. The terrain is empty after ClearWorld,
+// so the chain indices in the bodies carry over as they are.
+static void ReplaceWorld(const LevelView& level) {
+    worldWidth = max(worldWidth, level.worldWidth);
+    ClearWorld();
+    for (int c = 0; c < level.chainCount; ++c) {
+        terrain.AddChain(level.points + level.chains[c].first, level.chains[c].count);
+    }
+    terrain.Build();
+    bodies.Reserve(bodies.Count() + level.bodies.count);
+    bodies.AddRange(level.bodies);
+}
+
+bool LoadLevelText(const char* text, const char* name) {
+    LevelData level;
+    if (!CompileLevelText(text, name, level)) return false;
+
+    LevelView view;
+    view.worldWidth = level.worldWidth;
+    view.bodies = level.bodies.View();
+    view.pointCount = (int)level.terrain.points.size();
+    view.points = level.terrain.points.data();
+    view.chainCount = level.terrain.ChainCount();
+    view.chains = level.terrain.chains.data();
+    ReplaceWorld(view);
+    return true;
+}
+
+bool LoadLevel(const char* path) {
+    MappedFile file;
+    if (!file.Open(path)) {
+        fprintf(stderr, "%s: can't open\n", path);
+        return false;
+    }
+
+    uint32_t magic = 0;
+    if (file.size >= sizeof(magic)) memcpy(&magic, file.data, sizeof(magic));
+    if (magic != LEVEL_MAGIC) {
+        string text((const char*)file.data, file.size);
+        return LoadLevelText(text.c_str(), path);
+    }
+
+    LevelView view;
+    if (!MapLevel(file, path, view)) return false;
+    ReplaceWorld(view);
+    return true;
+}
+
+bool SaveWorldAsLevel(const char* path) {
+    return SaveLevel(path, worldWidth, bodies.View(1), terrain);   // body 0 is the ground (ClearWorld)
+}
@@ -5,6 +5,11 @@
 #include "raymath.h"
 #define RAYGUI_IMPLEMENTATION
 #include "raygui.h"
+#include "simulation.h"
+#include "simd_integrate.h"
+#include "level.h"
+#include "profiler.h"
+#include "snapshot.h"
 #include <string>
 #include <cmath>
 #include <vector>
@@ -19,21 +24,19 @@ const string studentName = "Tyron Fajardo";
 const string studentNumber = "101542713";
 
 // ------------------------------------------------------------
-// Simulation parameters
-const unsigned int TARGET_FPS = 50;
-float timeElapsed = 0.0f;
-float dt = 0.0f;
+// Simulation parameters (physics state and tunables live in simulation.cpp)
+const unsigned int TARGET_FPS = 50;     // render rate
 
-// World constants
-const float POS_CORRECT_PERCENT = 0.80f;  // positional correction
-const float POS_CORRECT_SLOP = 0.01f;
-const float STATIC_VEL_EPS = 0.05f;  // tiny velocity ~ stopped
+// Fixed-step accumulator: physics runs at physicsHz whatever the render rate
+const float MAX_FRAME_TIME = 0.25f;     // longest frame fed to the accumulator (spiral-of-death clamp)
+float accumulator = 0.0f;
+float renderAlpha = 1.0f;               // how far the render is between the last two physics states
+int   subStepsLastFrame = 0;
+vector<Vector2> previousPosition;       // positions before the last physics step
+vector<Vector2> previousRotation;       // rotations before the last physics step
 
 // ------------------ Adjustable via GUI ------------------
-float gravityAcc = 600.0f;   // px/s^2 (down)
-float globalRestitution = 0.25f;    // bounciness (0..1)
-float globalFrictionCoeff = 0.60f;    // dynamic friction (0..1)
-float pigToughness = 250.0f;   // how hard pigs are to kill
+float maxSubSteps = 8.0f;      // physics steps allowed per rendered frame
 
 float maxSlingshotPower = 900.0f;   // max launch speed
 float powerScale = 6.0f;     // power per pixel of drag
@@ -41,340 +44,172 @@ float powerScale = 6.0f;     // power per pixel of drag
 // ------------------------------------------------------------
 // Slingshot / bird selection
 
-enum ShapeType {
-    SHAPE_CIRCLE,
-    SHAPE_AABB
-};
-
-enum ObjectType {
-    OBJ_BIRD,
-    OBJ_BLOCK,
-    OBJ_PIG,
-    OBJ_STATIC_TERRAIN
-};
-
-struct Body {
-    // physics state
-    Vector2 position{ 0.0f, 0.0f };
-    Vector2 velocity{ 0.0f, 0.0f };
-
-    // geometry
-    float   radius = 8.0f;        // for circles
-    Vector2 halfExtents{ 10.0f, 10.0f }; // for AABBs
-
-    // physics properties
-    float   mass = 1.0f;
-    float   invMass = 1.0f;
-    float   restitution = 0.25f;
-    float   friction = 0.5f;
-
-    // game properties
-    ShapeType  shape = SHAPE_CIRCLE;
-    ObjectType type = OBJ_BLOCK;
-    Color      color = LIGHTGRAY;
-    bool       active = true;   // if false, skip update/draw
-    bool       alive = true;   // for pigs
-
-    // pig-specific
-    float toughness = 0.0f;
-};
-
-vector<Body> bodies;
-
-// Slingshot state
-Vector2 slingAnchor{ 200.0f, 550.0f };    // fixed slingshot pivot
+// Slingshot state (the anchor itself is world state)
 bool    isDragging = false;
 Vector2 dragStart{ 0.0f, 0.0f };
 Vector2 dragEnd{ 0.0f, 0.0f };
 
 int currentBirdType = 0; // 0 = circle, 1 = square
 
-// Ground (static)
-float groundY = 700.0f;
+// SPACE detonates the last bird once: the circle bird is one big blast,
+// the square one breaks into a ring of small ones
+const float BLAST_RADIUS = 140.0f;
+const float BLAST_STRENGTH = 2500.0f;     // impulse at the center
+const int   CLUSTER_BLASTS = 12;
+const float CLUSTER_SPREAD = 60.0f;       // ring radius
+const float CLUSTER_RADIUS = 60.0f;
+const float CLUSTER_STRENGTH = 700.0f;
+bool birdDetonated = false;
+
+// Debug view: S tints sleeping bodies (B, V, T, G, C toggle pipeline options)
+bool showSleeping = false;
+
+// Profiler overlay (P) and trace capture (F9 starts / stops, writes TRACE_PATH)
+bool showProfiler = false;
+const char* TRACE_PATH = "physics_trace.json";
+
+// Lockstep mode (D, restarts the level) and replay save (F5); the saved
+// script replays with: headless --script REPLAY_PATH --hash-log FILE
+const char* REPLAY_PATH = "replay.txt";
+const char* REPLAY_HASH_PATH = "replay_hashes.txt";
+
+// Rewind history: one snapshot per step over the last HISTORY_SECONDS.
+// Holding LEFT pauses physics and scrubs back (SHIFT: faster); letting go
+// resumes from there and the steps after it are forgotten.
+const float HISTORY_SECONDS = 10.0f;
+const int   SCRUB_FAST_STEPS = 5;       // steps per frame with SHIFT held
+SnapshotHistory history;
+bool scrubbing = false;
+
+// Score and impact sounds, both read from the contact events after each
+// step (each with its own cursor into the stream)
+const int   PIG_SCORE = 5000;             // per pig knocked out
+const float SCORE_PER_IMPULSE = 0.5f;     // for fresh hits on blocks and pigs
+const float SCORE_MIN_IMPULSE = 20.0f;    // lighter touches score nothing
+const float IMPACT_SOUND_IMPULSE = 40.0f; // weakest hit that makes a sound
+const float IMPACT_LOUD_IMPULSE = 600.0f; // hits this hard play at full volume
+const int   IMPACT_VOICES = 4;            // impact sounds that can overlap
+int score = 0;
+uint64_t scoreCursor = 0;
+uint64_t soundCursor = 0;
+vector<BodyHandle> scoredPigs;            // pigs already paid out
+Sound impactSound{};
+Sound impactVoices[IMPACT_VOICES];
+int   nextVoice = 0;
 
 // ------------------------------------------------------------
 // Math helpers
 
-static inline Vector2 SafeNormalize(const Vector2& v, const Vector2& fallback = { 1.0f, 0.0f }) {
-    float len = Vector2Length(v);
-    return (len > 1e-6f) ? Vector2Scale(v, 1.0f / len) : fallback;
-}
-
 // Clamp alias (from raymath)
 static inline float ClampFloat(float x, float minV, float maxV) {
     return Clamp(x, minV, maxV);
 }
 
-// Section two
-// ------------------------------------------------------------
-// Body creation helpers
-
-Body MakeCircle(ObjectType type, Vector2 pos, float radius, float mass, Color color) {
-    Body b;
-    b.position = pos;
-    b.velocity = { 0.0f, 0.0f };
-    b.radius = radius;
-    b.halfExtents = { radius, radius }; // just for convenience
-    b.mass = mass;
-    b.invMass = (mass > 0.0f) ? 1.0f / mass : 0.0f;
-    b.restitution = globalRestitution;
-    b.friction = globalFrictionCoeff;
-    b.shape = SHAPE_CIRCLE;
-    b.type = type;
-    b.color = color;
-    b.active = true;
-    b.alive = true;
-    b.toughness = (type == OBJ_PIG) ? pigToughness : 0.0f;
-    return b;
-}
-
-Body MakeAABB(ObjectType type, Vector2 pos, Vector2 halfExtents, float mass, Color color) {
-    Body b;
-    b.position = pos;
-    b.velocity = { 0.0f, 0.0f };
-    b.radius = max(halfExtents.x, halfExtents.y); // handy for debug
-    b.halfExtents = halfExtents;
-    b.mass = mass;
-    b.invMass = (mass > 0.0f) ? 1.0f / mass : 0.0f;
-    b.restitution = globalRestitution;
-    b.friction = globalFrictionCoeff;
-    b.shape = SHAPE_AABB;
-    b.type = type;
-    b.color = color;
-    b.active = true;
-    b.alive = true;
-    b.toughness = (type == OBJ_PIG) ? pigToughness : 0.0f;
-    return b;
+// Level file from the command line (binary or text, see level.h);
+// without one the default fort is built
+const char* levelPath = nullptr;
+
+// Fresh world; nothing to interpolate from yet
+void ResetWorld() {
+    if (!levelPath || !LoadLevel(levelPath)) BuildWorld();
+    score = 0;
+    scoredPigs.clear();
+    scoreCursor = soundCursor = contactEvents.Head();
+    previousPosition = bodies.position;
+    previousRotation = bodies.rotation;
+    history.Reset((int)(HISTORY_SECONDS * physicsHz));
+    history.Record();
 }
 
-// Section six
+// Section four
 // ------------------------------------------------------------
-// Geometry overlap tests (return penetration + contact normal)
-
-// Circle–Circle
-bool CircleCircleOverlap(const Body& a, const Body& b,
-    float& penetration, Vector2& normal) {
-    Vector2 ab = Vector2Subtract(b.position, a.position);
-    float dist = Vector2Length(ab);
-    float target = a.radius + b.radius;
-
-    if (dist <= 0.0001f) {
-        // overlapped almost exactly; choose any normal
-        normal = { 1.0f, 0.0f };
-        penetration = target;
-        return true;
-    }
-    if (dist >= target) return false;
-
-    normal = Vector2Scale(ab, 1.0f / dist);
-    penetration = target - dist;
-    return true;
-}
-
-// AABB–AABB (axis-aligned, centers at position, halfExtents)
-bool AABBAABBOverlap(const Body& a, const Body& b,
-    float& penetration, Vector2& normal) {
-    Vector2 diff = Vector2Subtract(b.position, a.position);
-    float overlapX = a.halfExtents.x + b.halfExtents.x - fabsf(diff.x);
-    float overlapY = a.halfExtents.y + b.halfExtents.y - fabsf(diff.y);
+// Input handling (slingshot + bird switching)
 
-    if (overlapX <= 0.0f || overlapY <= 0.0f) return false;
+void HandleSlingshotInput() {
+    Vector2 mouse = GetMousePosition();
 
-    // collision along axis of least penetration
-    if (overlapX < overlapY) {
-        penetration = overlapX;
-        normal = { (diff.x > 0.0f) ? 1.0f : -1.0f, 0.0f };
+    // Switch bird type (TAB)
+    if (IsKeyPressed(KEY_TAB)) {
+        currentBirdType = 1 - currentBirdType;
     }
-    else {
-        penetration = overlapY;
-        normal = { 0.0f, (diff.y > 0.0f) ? 1.0f : -1.0f };
+
+    // Cycle broadphase (B)
+    if (IsKeyPressed(KEY_B)) {
+        broadphaseMode = (BroadphaseMode)((broadphaseMode + 1) % BROADPHASE_COUNT);
     }
-    return true;
-}
 
-// Circle–AABB
-bool CircleAABBOverlap(const Body& circle, const Body& box,
-    float& penetration, Vector2& normal) {
-    // closest point on AABB to circle center
-    Vector2 diff = Vector2Subtract(circle.position, box.position);
-    Vector2 clamped = {
-        Clamp(diff.x, -box.halfExtents.x, box.halfExtents.x),
-        Clamp(diff.y, -box.halfExtents.y, box.halfExtents.y)
-    };
-    Vector2 closest = Vector2Add(box.position, clamped);
-
-    // IMPORTANT: vector from circle -> closest point on box
-    Vector2 v = Vector2Subtract(closest, circle.position);
-    float dist2 = Vector2LengthSqr(v);
-    float r = circle.radius;
-
-    if (dist2 > r * r) return false;
-
-    float dist = sqrtf(dist2);
-
-    if (dist <= 0.0001f) {
-        // Circle center is inside/on the box – pick a normal from circle to box center
-        Vector2 fallback = Vector2Subtract(box.position, circle.position);
-        normal = SafeNormalize(fallback, { 0.0f, 1.0f });
-        penetration = r;  // approximate
-        return true;
-    }
-
-    // normal points from circle -> box (matches ResolveContact assumption)
-    normal = Vector2Scale(v, 1.0f / dist);
-    penetration = r - dist;
-    return true;
-}
+    // Cycle SIMD level for integration + narrowphase (V), capped at what the CPU supports
+    if (IsKeyPressed(KEY_V)) {
+        SimdLevel next = (SimdLevel)((GetSimdLevel() + 1) % (DetectSimdLevel() + 1));
+        SetSimdLevel(next);
+    }
 
-// Section seven
-// ------------------------------------------------------------
-// Generic collision resolution (impulse + friction + pig toughness)
-
-void ResolveContact(Body& a, Body& b, float penetration, const Vector2& normal) {
-    if (!a.active || !b.active) return;
-    if (!a.alive || !b.alive)   return;
-
-    float invA = a.invMass;
-    float invB = b.invMass;
-    float invSum = invA + invB;
-    if (invSum <= 0.0f) return; // two static objects
-
-	// Section eight
-    // --- (1) Pig toughness check (use pre-collision momenta) ---
-    // approximate "total momentum magnitude" as |m1 v1 - m2 v2|
-    Vector2 p1 = Vector2Scale(a.velocity, a.mass);
-    Vector2 p2 = Vector2Scale(b.velocity, b.mass);
-    float relMomMag = Vector2Length(Vector2Subtract(p1, p2));
-
-    if (a.type == OBJ_PIG && a.alive && relMomMag > a.toughness) {
-        a.alive = false;
-        a.active = false;
-    }
-    if (b.type == OBJ_PIG && b.alive && relMomMag > b.toughness) {
-        b.alive = false;
-        b.active = false;
-    }
-
-    // If pig died, still allow their last interaction to push things
-    // ---------------------------------------------------------------
-
-    // --- (2) Positional correction ---
-    float remove = max(penetration - POS_CORRECT_SLOP, 0.0f) * POS_CORRECT_PERCENT / invSum;
-    Vector2 corr = Vector2Scale(normal, remove);
-    a.position = Vector2Subtract(a.position, Vector2Scale(corr, invA));
-    b.position = Vector2Add(b.position, Vector2Scale(corr, invB));
-
-    // --- (3) Velocity impulse (normal) ---
-    Vector2 rv = Vector2Subtract(b.velocity, a.velocity);
-    float velAlongNormal = Vector2DotProduct(rv, normal);
-    if (velAlongNormal > 0.0f) return; // already separating
-
-    float e = min(a.restitution, b.restitution);
-    float j = -(1.0f + e) * velAlongNormal;
-    j /= invSum;
-
-    Vector2 impulse = Vector2Scale(normal, j);
-    a.velocity = Vector2Subtract(a.velocity, Vector2Scale(impulse, invA));
-    b.velocity = Vector2Add(b.velocity, Vector2Scale(impulse, invB));
-
-    // --- (4) Friction impulse (Coulomb, dynamic only for simplicity) ---
-    rv = Vector2Subtract(b.velocity, a.velocity);
-    Vector2 tangent = SafeNormalize(Vector2Subtract(rv, Vector2Scale(normal, Vector2DotProduct(rv, normal))),
-        { -normal.y, normal.x });
-    float vt = Vector2DotProduct(rv, tangent);
-    if (fabsf(vt) < STATIC_VEL_EPS) return; // almost no tangential motion
-
-    float mu = 0.5f * (a.friction + b.friction);
-    float jt = -vt / invSum;
-    float maxFriction = mu * j;
-
-    jt = ClampFloat(jt, -maxFriction, maxFriction);
-    Vector2 frictionImpulse = Vector2Scale(tangent, jt);
-    a.velocity = Vector2Subtract(a.velocity, Vector2Scale(frictionImpulse, invA));
-    b.velocity = Vector2Add(b.velocity, Vector2Scale(frictionImpulse, invB));
-}
+    // Toggle sleeping-body tint (S)
+    if (IsKeyPressed(KEY_S)) {
+        showSleeping = !showSleeping;
+    }
 
-// Section three
-// ------------------------------------------------------------
-// World setup
-
-void BuildWorld() {
-    bodies.clear();
-
-    // Ground (big static AABB)
-    {
-        Vector2 pos = { (float)GetScreenWidth() * 0.5f, groundY + 20.0f };
-        Vector2 half = { (float)GetScreenWidth(), 40.0f };
-        Body ground = MakeAABB(OBJ_STATIC_TERRAIN, pos, half, 0.0f, DARKGREEN);
-        ground.restitution = 0.2f;
-        ground.friction = 0.9f;
-        bodies.push_back(ground);
-    }
-
-    // Fort blocks (3+ blocks high)
-    // Simple tower near right side
-    Vector2 basePos = { 850.0f, groundY - 25.0f };
-    Vector2 halfBlock{ 25.0f, 25.0f };
-    float blockMass = 4.0f;
-
-    int cols = 3;
-    int rows = 4;
-
-    for (int y = 0; y < rows; ++y) {
-        for (int x = 0; x < cols; ++x) {
-            Vector2 pos = {
-                basePos.x + (x - (cols / 2)) * (halfBlock.x * 2.2f),
-                basePos.y - y * (halfBlock.y * 2.05f)
-            };
-            Body block = MakeAABB(OBJ_BLOCK, pos, halfBlock, blockMass, BROWN);
-            bodies.push_back(block);
-        }
+    // Toggle worker threads (T): single-threaded vs one per hardware thread
+    if (IsKeyPressed(KEY_T)) {
+        jobs.Start(jobs.ThreadCount() > 1 ? 1 : 0);
     }
 
-    // Pigs (circles) on top and inside fort
-    {
-        // on top
-        Vector2 pigPosTop = { basePos.x, basePos.y - rows * (halfBlock.y * 2.1f) - 20.0f };
-        Body pigTop = MakeCircle(OBJ_PIG, pigPosTop, 15.0f, 1.5f, GREEN);
-        bodies.push_back(pigTop);
+    // Toggle graph coloring for big islands (G)
+    if (IsKeyPressed(KEY_G)) {
+        contactSolver.graphColoring = !contactSolver.graphColoring;
+    }
 
-        // inside fort (middle row)
-        Vector2 pigInside = { basePos.x, basePos.y - 1.5f * (halfBlock.y * 2.0f) };
-        Body pigIn = MakeCircle(OBJ_PIG, pigInside, 15.0f, 1.5f, GREEN);
-        bodies.push_back(pigIn);
+    // Toggle continuous collision for fast bodies (C)
+    if (IsKeyPressed(KEY_C)) {
+        ccdEnabled = !ccdEnabled;
     }
-}
 
-// Create a bird at the slingshot anchor
-void SpawnBird(const Vector2& velocity) {
-    Body bird;
-    if (currentBirdType == 0) {
-        // Circular light bird
-        bird = MakeCircle(OBJ_BIRD, slingAnchor, 12.0f, 1.0f, YELLOW);
+    // Profiler overlay (P), trace capture (F9)
+    if (IsKeyPressed(KEY_P)) {
+        showProfiler = !showProfiler;
     }
-    else {
-        // Square heavy bird
-        bird = MakeAABB(OBJ_BIRD, slingAnchor, { 14.0f, 14.0f }, 4.0f, RED);
+    if (IsKeyPressed(KEY_F9)) {
+        if (!profiler.Tracing()) profiler.StartTrace();
+        else if (profiler.StopTrace(TRACE_PATH)) TraceLog(LOG_INFO, "profiler: wrote %s", TRACE_PATH);
+        else TraceLog(LOG_WARNING, "profiler: could not write %s", TRACE_PATH);
     }
-    bird.velocity = velocity;
-    bodies.push_back(bird);
-}
-
-// Section four
-// ------------------------------------------------------------
-// Input handling (slingshot + bird switching)
 
-void HandleSlingshotInput() {
-    Vector2 mouse = GetMousePosition();
+    // Lockstep mode (D): record from a fresh level so the replay starts at step 0
+    if (IsKeyPressed(KEY_D)) {
+        deterministicMode = !deterministicMode;
+        ResetWorld();
+    }
+    if (IsKeyPressed(KEY_F5) && deterministicMode) {
+        if (SaveReplayScript(REPLAY_PATH, replayEvents) && SaveHashLog(REPLAY_HASH_PATH, stepHashes)) {
+            TraceLog(LOG_INFO, "replay: wrote %s + %s (%i steps)", REPLAY_PATH, REPLAY_HASH_PATH, (int)stepIndex);
+        }
+        else TraceLog(LOG_WARNING, "replay: could not write %s", REPLAY_PATH);
+    }
 
-    // Switch bird type (TAB)
-    if (IsKeyPressed(KEY_TAB)) {
-        currentBirdType = 1 - currentBirdType;
+    // Scrub back (LEFT, held). A restored world is quantized, so it can't
+    // continue a lockstep recording.
+    scrubbing = IsKeyDown(KEY_LEFT) && !deterministicMode;
+
+    // Detonate the last bird (SPACE)
+    if (IsKeyPressed(KEY_SPACE) && !birdDetonated) {
+        int bird = bodies.IndexOf(lastBird);
+        if (bird >= 0 && bodies.active[bird]) {
+            Vector2 at = bodies.position[bird];
+            if (bodies.shape[bird].type == SHAPE_CIRCLE) ApplyRadialImpulse(at, BLAST_RADIUS, BLAST_STRENGTH);
+            else {
+                for (int k = 0; k < CLUSTER_BLASTS; ++k) {
+                    float a = 2.0f * PI * k / CLUSTER_BLASTS;
+                    Vector2 c = Vector2Add(at, { cosf(a) * CLUSTER_SPREAD, sinf(a) * CLUSTER_SPREAD });
+                    ApplyRadialImpulse(c, CLUSTER_RADIUS, CLUSTER_STRENGTH);
+                }
+            }
+            birdDetonated = true;
+        }
     }
 
     // Reset world (R)
     if (IsKeyPressed(KEY_R)) {
-        BuildWorld();
+        ResetWorld();
     }
 
     // Start drag near slingshot anchor
@@ -399,106 +234,206 @@ void HandleSlingshotInput() {
                 Vector2 dir = Vector2Scale(dragVec, 1.0f / dragLen);
                 float speed = clampedLen * powerScale;
                 Vector2 vel = Vector2Scale(dir, speed);
-                SpawnBird(vel);
+                SpawnBird(vel, currentBirdType);
+                birdDetonated = false;
             }
             isDragging = false;
         }
     }
 }
 
-// Section five
-// ------------------------------------------------------------
-// Physics update
-
-void UpdatePhysics() {
-    // Integrate velocities & positions
-    for (auto& b : bodies) {
-        if (!b.active) continue;
-        if (b.invMass == 0.0f) continue; // static
+// The step packed removed bodies out of the store: move the interpolation
+// start of the survivors to their new indices
+static void RemapPrevious(vector<Vector2>& previous) {
+    const vector<int>& remap = bodies.LastRemap();
+    vector<Vector2> moved(bodies.Count());
+    for (size_t i = 0; i < remap.size() && i < previous.size(); ++i) {
+        if (remap[i] >= 0) moved[remap[i]] = previous[i];
+    }
+    previous.swap(moved);
+}
 
-        // gravity
-        b.velocity.y += gravityAcc * dt;
+static void RemapPreviousPositions() {
+    RemapPrevious(previousPosition);
+    RemapPrevious(previousRotation);
+}
 
-        // integrate
-        b.position.x += b.velocity.x * dt;
-        b.position.y += b.velocity.y * dt;
+// ------------------------------------------------------------
+// Score and impact sounds
+
+// A short thump: a low decaying tone with a little noise on the attack
+static void LoadImpactSound() {
+    if (!IsAudioDeviceReady()) return;
+    const int rate = 22050;
+    const int frames = rate / 8;
+    vector<short> samples(frames);
+    uint32_t noise = 12345u;
+    for (int i = 0; i < frames; ++i) {
+        float t = (float)i / rate;
+        noise = noise * 1664525u + 1013904223u;
+        float hiss = ((float)(noise >> 16) / 32768.0f - 1.0f) * expf(-t * 60.0f);
+        float tone = sinf(2.0f * PI * 90.0f * t) * expf(-t * 25.0f);
+        samples[i] = (short)(Clamp(0.8f * tone + 0.3f * hiss, -1.0f, 1.0f) * 32000.0f);
     }
+    Wave wave = { (unsigned int)frames, (unsigned int)rate, 16, 1, samples.data() };
+    impactSound = LoadSoundFromWave(wave);
+    for (Sound& voice : impactVoices) voice = LoadSoundAlias(impactSound);
+}
 
-    // Collision detection & response (all pairs)
-    const size_t n = bodies.size();
-    for (size_t i = 0; i < n; ++i) {
-        for (size_t j = i + 1; j < n; ++j) {
-            Body& a = bodies[i];
-            Body& b = bodies[j];
-            if (!a.active || !b.active) continue;
-
-            float penetration = 0.0f;
-            Vector2 normal{ 0.0f, 0.0f };
-            bool overlapped = false;
+static void UnloadImpactSound() {
+    if (!IsAudioDeviceReady()) return;
+    for (Sound& voice : impactVoices) UnloadSoundAlias(voice);
+    UnloadSound(impactSound);
+}
 
-            if (a.shape == SHAPE_CIRCLE && b.shape == SHAPE_CIRCLE) {
-                overlapped = CircleCircleOverlap(a, b, penetration, normal);
-            }
-            else if (a.shape == SHAPE_AABB && b.shape == SHAPE_AABB) {
-                overlapped = AABBAABBOverlap(a, b, penetration, normal);
-            }
-            else if (a.shape == SHAPE_CIRCLE && b.shape == SHAPE_AABB) {
-                overlapped = CircleAABBOverlap(a, b, penetration, normal);
-            }
-            else if (a.shape == SHAPE_AABB && b.shape == SHAPE_CIRCLE) {
-                overlapped = CircleAABBOverlap(b, a, penetration, normal);
-                normal = Vector2Scale(normal, -1.0f); // flip to a->b
-            }
+static bool SameHandle(BodyHandle l, BodyHandle r) {
+    return l.id == r.id && l.generation == r.generation;
+}
 
-            if (overlapped) {
-                ResolveContact(a, b, penetration, normal);
-            }
+// Points for every fresh hit on a block or pig, and a bonus for each pig
+// that is gone after a step it had contacts in (its handle went stale)
+static void UpdateScore() {
+    contactEvents.Read(scoreCursor, [](const ContactEvent& e) {
+        if (e.type == CONTACT_END) return;
+        bool target = e.typeA == OBJ_BLOCK || e.typeA == OBJ_PIG || e.typeB == OBJ_BLOCK || e.typeB == OBJ_PIG;
+        if (e.type == CONTACT_BEGIN && target && e.normalImpulse >= SCORE_MIN_IMPULSE) {
+            score += (int)(e.normalImpulse * SCORE_PER_IMPULSE);
         }
-    }
 
-    // Small damping for sleeping objects
-    for (auto& b : bodies) {
-        if (!b.active || b.invMass == 0.0f) continue;
-        if (fabsf(b.velocity.x) < 0.02f && fabsf(b.velocity.y) < 0.02f) {
-            b.velocity = { 0.0f, 0.0f };
+        BodyHandle pigs[2] = { e.typeA == OBJ_PIG ? e.a : BodyHandle(), e.typeB == OBJ_PIG ? e.b : BodyHandle() };
+        for (BodyHandle pig : pigs) {
+            if (!pig.IsValid() || bodies.IndexOf(pig) >= 0) continue;
+            bool scored = false;
+            for (BodyHandle s : scoredPigs) scored = scored || SameHandle(s, pig);
+            if (scored) continue;
+            scoredPigs.push_back(pig);
+            score += PIG_SCORE;
         }
-    }
+    });
+}
+
+// The hardest fresh hit of the step makes a sound, louder the harder it was
+static void PlayImpactSounds() {
+    float hardest = 0.0f;
+    contactEvents.Read(soundCursor, [&hardest](const ContactEvent& e) {
+        if (e.type == CONTACT_BEGIN) hardest = max(hardest, e.normalImpulse);
+    });
+    if (!IsAudioDeviceReady() || hardest < IMPACT_SOUND_IMPULSE) return;
+
+    Sound& voice = impactVoices[nextVoice];
+    nextVoice = (nextVoice + 1) % IMPACT_VOICES;
+    SetSoundVolume(voice, ClampFloat(hardest / IMPACT_LOUD_IMPULSE, 0.1f, 1.0f));
+    PlaySound(voice);
 }
 
 // ------------------------------------------------------------
 void update() {
-    dt = 1.0f / TARGET_FPS;
-    timeElapsed += dt;
+    dt = 1.0f / physicsHz;
 
     // Update pig toughness & friction/restitution into new bodies too
     // (for simplicity, some properties are applied when building world or spawning birds)
 
     HandleSlingshotInput();
-    UpdatePhysics();
+
+    if (scrubbing) {
+        bool fast = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+        history.Rewind(fast ? SCRUB_FAST_STEPS : 1);
+        previousPosition = bodies.position;
+        previousRotation = bodies.rotation;
+        accumulator = 0.0f;
+        renderAlpha = 1.0f;
+        subStepsLastFrame = 0;
+        return;
+    }
+
+    // Real frame time goes into the accumulator and comes out in fixed
+    // steps. Long frames (window drag, breakpoint) are clamped, and time
+    // that still doesn't fit in maxSubSteps is dropped so a slow frame
+    // can't snowball into ever more steps.
+    accumulator += min(GetFrameTime(), MAX_FRAME_TIME);
+
+    subStepsLastFrame = 0;
+    while (accumulator >= dt && subStepsLastFrame < (int)maxSubSteps) {
+        previousPosition = bodies.position;
+        previousRotation = bodies.rotation;
+        int compactions = bodies.CompactionCount();
+        UpdatePhysics();
+        if (bodies.CompactionCount() != compactions) RemapPreviousPositions();
+        UpdateScore();
+        PlayImpactSounds();
+        history.Record();
+        accumulator -= dt;
+        timeElapsed += dt;
+        ++subStepsLastFrame;
+    }
+    if (accumulator >= dt) accumulator = fmodf(accumulator, dt);
+
+    renderAlpha = accumulator / dt;
 }
 
 // ------------------------------------------------------------
 // Drawing helpers
 
-void DrawBody(const Body& b) {
-    if (!b.active) return;
+// Render position between the previous and current physics state, so
+// motion stays smooth when physics and rendering run at different rates.
+// Bodies spawned since the last step have no previous state yet.
+static Vector2 RenderPosition(int i) {
+    if (i >= (int)previousPosition.size()) return bodies.position[i];
+    return Vector2Lerp(previousPosition[i], bodies.position[i], renderAlpha);
+}
+
+// Rotations are blended the same way, then brought back to unit length
+static Vector2 RenderRotation(int i) {
+    if (i >= (int)previousRotation.size()) return bodies.rotation[i];
+    return Vector2Normalize(Vector2Lerp(previousRotation[i], bodies.rotation[i], renderAlpha));
+}
+
+void DrawBody(int i) {
+    if (!bodies.active[i]) return;
 
-    if (b.shape == SHAPE_CIRCLE) {
-        Color c = b.color;
-        if (b.type == OBJ_PIG) {
-            c = b.alive ? GREEN : DARKGREEN;
+    const BodyShape& s = bodies.shape[i];
+    const BodyGameData& g = bodies.game[i];
+    Vector2 pos = RenderPosition(i);
+
+    if (s.type == SHAPE_CIRCLE) {
+        Color c = g.color;
+        if (showSleeping && !bodies.awake[i]) c = ColorLerp(c, SKYBLUE, 0.6f);
+        DrawCircleV(pos, s.radius, c);
+        // a spoke, so rolling shows
+        Vector2 rim = Vector2Add(pos, Vector2Scale(RenderRotation(i), s.radius));
+        DrawLineEx(pos, rim, 2.0f, Fade(BLACK, 0.25f));
+    }
+    else if (s.type == SHAPE_POLYGON) {
+        // fan in reverse order: raylib wants the other winding on screen
+        const ConvexPolygon& poly = bodies.polygons[s.polygon];
+        Vector2 rot = RenderRotation(i);
+        Vector2 points[MAX_POLYGON_VERTICES];
+        for (int k = 0; k < poly.count; ++k) {
+            points[poly.count - 1 - k] = Vector2Add(pos, Rotate(rot, poly.vertices[k]));
+        }
+
+        Color c = g.color;
+        if (showSleeping && !bodies.awake[i]) c = ColorLerp(c, SKYBLUE, 0.6f);
+        DrawTriangleFan(points, poly.count, c);
+        for (int k = 0; k < poly.count; ++k) {
+            DrawLineEx(points[k], points[(k + 1) % poly.count], 1.0f, Fade(BLACK, 0.3f));
         }
-        DrawCircleV(b.position, b.radius, c);
+    }
+    else if (s.type == SHAPE_CHAIN) {
+        const TerrainChain& chain = terrain.chains[s.chain];
+        DrawSplineLinear(&terrain.points[chain.first], chain.count, 3.0f, g.color);
     }
     else {
         // AABB
         Rectangle rect;
-        rect.width = b.halfExtents.x * 2.0f;
-        rect.height = b.halfExtents.y * 2.0f;
-        rect.x = b.position.x - b.halfExtents.x;
-        rect.y = b.position.y - b.halfExtents.y;
-
-        DrawRectangleRec(rect, b.color);
+        rect.width = s.halfExtents.x * 2.0f;
+        rect.height = s.halfExtents.y * 2.0f;
+        rect.x = pos.x - s.halfExtents.x;
+        rect.y = pos.y - s.halfExtents.y;
+
+        Color c = g.color;
+        if (showSleeping && !bodies.awake[i]) c = ColorLerp(c, SKYBLUE, 0.6f);
+        DrawRectangleRec(rect, c);
     }
 }
 
@@ -527,19 +462,104 @@ void DrawSlingshot() {
     }
 }
 
+// Per-phase frame times over the last Profiler::HISTORY frames, one line
+// per phase, with the rolling average and p99 in the legend
+void DrawProfilerOverlay() {
+    static const Color phaseColors[PHASE_COUNT] = { SKYBLUE, ORANGE, YELLOW, RED, LIME, VIOLET };
+    const int w = 400, h = 170;
+    const int x = GetScreenWidth() - w - 10, y = 280;   // below the HUD lines
+    const int graphX = x + 190, graphW = w - 200, graphH = h - 30;
+
+    DrawRectangle(x, y, w, h, Fade(BLACK, 0.75f));
+    DrawRectangleLines(x, y, w, h, DARKGRAY);
+
+    // scale: the largest p99, rounded up to a whole 0.5 ms
+    double top = 0.5e6;
+    for (int p = 0; p < PHASE_COUNT; ++p) top = max(top, profiler.Percentile((ProfilePhase)p, 0.99));
+    top = ceil(top / 0.5e6) * 0.5e6;
+
+    DrawText(TextFormat("phase        avg / p99 ms   (%.1f ms)", top * 1e-6), x + 8, y + 6, 10, GRAY);
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+        ProfilePhase phase = (ProfilePhase)p;
+        DrawText(TextFormat("%-12s %6.3f / %6.3f", ProfilePhaseName(phase),
+            profiler.Average(phase) * 1e-6, profiler.Percentile(phase, 0.99) * 1e-6),
+            x + 8, y + 24 + p * 18, 10, phaseColors[p]);
+
+        // newest sample on the right
+        int n = profiler.Samples();
+        for (int i = 0; i + 1 < n; ++i) {
+            float x0 = graphX + graphW - (float)graphW * (i + 1) / Profiler::HISTORY;
+            float x1 = graphX + graphW - (float)graphW * i / Profiler::HISTORY;
+            float y0 = y + 20 + graphH * (1.0f - (float)min(1.0, profiler.Sample(phase, i + 1) / top));
+            float y1 = y + 20 + graphH * (1.0f - (float)min(1.0, profiler.Sample(phase, i) / top));
+            DrawLineV({ x0, y0 }, { x1, y1 }, phaseColors[p]);
+        }
+    }
+    DrawRectangleLines(graphX, y + 20, graphW, graphH, DARKGRAY);
+
+    if (profiler.Tracing()) {
+        DrawText(TextFormat("TRACE  %i events (F9 to save)", profiler.TraceEventCount()), x + 8, y + h - 18, 10, RED);
+    }
+}
+
 // ------------------------------------------------------------
 void draw() {
     BeginDrawing();
+    int64_t drawStart = ProfileNowNs();
     ClearBackground(BLACK);
 
     // Student info
     DrawText(("Name: " + studentName).c_str(), 10, GetScreenHeight() - 40, 20, LIGHTGRAY);
     DrawText(("Student Number: " + studentNumber).c_str(), 10, GetScreenHeight() - 20, 20, LIGHTGRAY);
+    DrawText(TextFormat("Score: %i", score), 10, GetScreenHeight() - 62, 20, GOLD);
 
     // Time/FPS
     DrawText(TextFormat("Time: %.2f  |  FPS: %i", timeElapsed, GetFPS()),
         GetScreenWidth() - 260, 10, 20, LIGHTGRAY);
 
+    // Broadphase stats
+    DrawText(TextFormat("Broadphase: %s  |  pairs: %i (%i static)", BroadphaseModeName(broadphaseMode), (int)candidatePairs.size(), staticIndex.pairCount),
+        GetScreenWidth() - 380, 34, 18, GRAY);
+    DrawText(TextFormat("SIMD: %s  |  contacts: %i  |  batches: %i  |  terrain: %i", SimdLevelName(GetSimdLevel()),
+        narrowphase.contactCount, narrowphase.simdBatches, narrowphase.terrainContactCount),
+        GetScreenWidth() - 490, 78, 18, GRAY);
+    DrawText(TextFormat("Manifolds: %i  |  new %i  |  kept %i  |  removed %i", (int)manifoldCache.manifolds.size(),
+        manifoldCache.created, manifoldCache.kept, manifoldCache.removed),
+        GetScreenWidth() - 470, 100, 18, GRAY);
+    DrawText(TextFormat("Islands: %i  |  sleeping %i  |  woken %i  |  threads %i",
+        islands.islandCount, islands.sleepingCount, islands.wokenCount, jobs.ThreadCount()),
+        GetScreenWidth() - 480, 122, 18, GRAY);
+    DrawText(TextFormat("Solver: rows %i  |  colored %i  |  colors %i  |  overflow %i",
+        (int)contactSolver.constraints.size(), contactSolver.coloredIslands, contactSolver.colorCount,
+        contactSolver.overflowRows),
+        GetScreenWidth() - 470, 144, 18, GRAY);
+    DrawText(TextFormat("Physics: %.0f Hz  |  substeps %i  |  alpha %.2f", physicsHz, subStepsLastFrame, renderAlpha),
+        GetScreenWidth() - 420, 166, 18, GRAY);
+    DrawText(TextFormat("CCD: %s  |  fast %i  |  hits %i  |  segments %i", ccdEnabled ? "on" : "off", ccd.fastCount,
+        ccd.hitCount, ccd.segmentsSwept), GetScreenWidth() - 420, 188, 18, GRAY);
+    DrawText(TextFormat("History: %.1f s  |  %i KB  |  keyframes %i%s", history.Count() / physicsHz,
+        (int)(history.Bytes() / 1024), history.keyCount, scrubbing ? "  |  REWIND" : ""),
+        GetScreenWidth() - 420, 210, 18, scrubbing ? ORANGE : GRAY);
+    DrawText(TextFormat("Events: %i  |  begin %i  |  end %i", contactEvents.published,
+        contactEvents.begins, contactEvents.ends),
+        GetScreenWidth() - 380, 254, 18, GRAY);
+    if (deterministicMode) {
+        DrawText(TextFormat("Lockstep: step %u  |  hash %016llx", stepIndex,
+            (unsigned long long)(stepHashes.empty() ? 0 : stepHashes.back())),
+            GetScreenWidth() - 420, 232, 18, GRAY);
+    }
+    if (broadphaseMode == BROADPHASE_SAP) {
+        DrawText(TextFormat("SAP: candidates %i  |  axis overlaps %i  |  swaps %i  |  sweep %s",
+            broadphaseSap.candidateCount, broadphaseSap.sweepOverlaps, broadphaseSap.swapCount,
+            broadphaseSap.sweepAxis == 0 ? "x" : "y"),
+            GetScreenWidth() - 560, 56, 18, GRAY);
+    }
+    else if (broadphaseMode == BROADPHASE_TREE) {
+        DrawText(TextFormat("Tree: leaves %i  |  height %i  |  reinserted %i",
+            broadphaseTree.leafCount, broadphaseTree.tree.Height(), broadphaseTree.reinsertCount),
+            GetScreenWidth() - 450, 56, 18, GRAY);
+    }
+
     // ----------------- GUI (two columns) -----------------
     const float colWidth = 240.0f;
     const float colGap = 80.0f;
@@ -564,6 +584,15 @@ void draw() {
     GuiSliderBar({ col1X, y1, colWidth, 20 }, "Pig Toughness",
         TextFormat("%.0f", pigToughness), &pigToughness, 50.0f, 800.0f); y1 += DY + 10;
 
+    GuiSliderBar({ col1X, y1, colWidth, 20 }, "Solver Iters",
+        TextFormat("%i", (int)solverIterations), &solverIterations, 1.0f, 30.0f); y1 += DY;
+
+    GuiSliderBar({ col1X, y1, colWidth, 20 }, "Physics Hz",
+        TextFormat("%.0f", physicsHz), &physicsHz, 30.0f, 240.0f); y1 += DY;
+
+    GuiSliderBar({ col1X, y1, colWidth, 20 }, "Max Substeps",
+        TextFormat("%i", (int)maxSubSteps), &maxSubSteps, 1.0f, 16.0f); y1 += DY;
+
     // ------- Column 2: slingshot tuning -------
     DrawText("Slingshot", col2X, y2 - 6, 18, LIGHTGRAY); y2 += DY;
     GuiSliderBar({ col2X, y2, colWidth, 20 }, "Max Power",
@@ -576,46 +605,74 @@ void draw() {
     const char* birdLabel = (currentBirdType == 0) ? "Bird: Circle (light)" : "Bird: Square (heavy)";
     DrawText(birdLabel, col2X, y2 + 4, 18, YELLOW); y2 += DY;
 
+    // Last launched bird
+    int bird = bodies.IndexOf(lastBird);
+    if (bird >= 0 && bodies.active[bird]) {
+        DrawText(TextFormat("Last bird speed: %.0f", Vector2Length(bodies.velocity[bird])),
+            col2X, y2 + 4, 18, GRAY); y2 += DY;
+    }
+
     // ----------------- Scene drawing -----------------
 
     // Slingshot
     DrawSlingshot();
 
     // Bodies
-    for (auto& b : bodies) {
-        DrawBody(b);
+    for (int i = 0; i < bodies.Count(); ++i) {
+        DrawBody(i);
     }
 
     // Instructions
     DrawText(
         "Controls:\n"
         "  LMB near slingshot: click, drag, release to launch.\n"
-        "  TAB: switch bird (circle vs square).\n"
-        "  R: reset fort.\n"
+        "  TAB: switch bird (circle vs square).  SPACE: detonate the last bird.\n"
+        "  R: reset (the fort, or the level file given on the command line).\n"
+        "  LEFT (hold): scrub back through the last 10 s (SHIFT: faster).\n"
+        "  B: cycle broadphase (brute force / grid / sweep and prune / tree).\n"
+        "  V: cycle SIMD level (scalar / SSE2 / AVX2).\n"
+        "  S: tint sleeping bodies.\n"
+        "  T: toggle worker threads (1 / all cores).\n"
+        "  G: toggle graph-colored solving of big islands.\n"
+        "  C: toggle continuous collision for fast bodies.\n"
+        "  P: profiler overlay.  F9: start / stop a trace capture.\n"
+        "  D: lockstep mode (restarts, hashes every step).  F5: save replay + hashes.\n"
         "Notes:\n"
         "  - Pigs (green) die when collision momentum exceeds their Toughness.\n"
-        "  - Blocks are AABB, Birds can be Sphere or AABB.\n"
-        "  - Collisions use impulses with restitution and friction.",
-        20, GetScreenHeight() - 200, 18, GRAY);
+        "  - Blocks and the square bird are rotating convex polygons; pigs and the round bird are circles.\n"
+        "  - Collisions use a sequential-impulse solver (warm started) with restitution and friction.",
+        20, GetScreenHeight() - 400, 18, GRAY);
+
+    profiler.Record(PHASE_DRAW, drawStart, ProfileNowNs());
+    if (showProfiler || profiler.Tracing()) DrawProfilerOverlay();
 
     EndDrawing();
 }
 
 // ------------------------------------------------------------
-int main() {
+int main(int argc, char** argv) {
+    if (argc > 1) levelPath = argv[1];
+
     InitWindow(1200, 800, ("Game Physics - " + studentName + " " + studentNumber).c_str());
     SetTargetFPS(TARGET_FPS);
+    InitAudioDevice();
+    LoadImpactSound();
+    jobs.Start();
 
     groundY = 700.0f;
     slingAnchor = { 200.0f, groundY - 150.0f };
+    worldWidth = (float)GetScreenWidth();
 
-    BuildWorld();
+    ResetWorld();
 
     while (!WindowShouldClose()) {
         update();
         draw();
+        profiler.EndFrame();
     }
 
+    UnloadImpactSound();
+    CloseAudioDevice();
     CloseWindow();
     return 0;
 }
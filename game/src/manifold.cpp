@@ -0,0 +1,90 @@
+#include "fp_mode.h"
+#include "manifold.h"
+
+#include <algorithm>
+
+using namespace std;
+
+static inline bool ManifoldBefore(const ContactManifold& l, const ContactManifold& r) {
+    return (l.key != r.key) ? (l.key < r.key) : (l.child < r.child);
+}
+
+void ManifoldCache::Clear() {
+    manifolds.clear();
+    ended.clear();
+    created = kept = removed = 0;
+}
+
+void ManifoldCache::Remap(const vector<int>& newIndex) {
+    size_t out = 0;
+    for (ContactManifold m : manifolds) {
+        m.a = newIndex[m.a];
+        m.b = newIndex[m.b];
+        if (m.a >= 0 && m.b >= 0) manifolds[out++] = m;
+    }
+    manifolds.resize(out);
+}
+
+void ManifoldCache::Update(const BodyStore& bodies, const vector<Contact>& contacts) {
+    // (1) this step's contacts as manifolds, sorted by pair key
+    incoming.clear();
+    for (const Contact& c : contacts) {
+        ContactManifold m;
+        m.key = PairKey(bodies.HandleOf(c.a), bodies.HandleOf(c.b));
+        m.child = c.child;
+        m.a = c.a;
+        m.b = c.b;
+        m.normal = c.normal;
+        m.penetration = c.penetration;
+        m.pointCount = c.pointCount;
+        for (int k = 0; k < c.pointCount; ++k) {
+            m.points[k].position = c.points[k].position;
+            m.points[k].penetration = c.points[k].penetration;
+            m.points[k].id = c.points[k].id;
+        }
+        incoming.push_back(m);
+    }
+    sort(incoming.begin(), incoming.end(), ManifoldBefore);
+
+    // (2) merge with last step's list: both sides are sorted, so one pass
+    previous.swap(manifolds);
+    manifolds.clear();
+    ended.clear();
+    created = kept = removed = 0;
+
+    size_t i = 0, j = 0;
+    while (i < incoming.size() || j < previous.size()) {
+        // a removed body's handle id can be handed out again before the next
+        // Compact drops its manifolds: end them here, so a new body with the
+        // same id never matches them
+        if (j < previous.size() && (bodies.IsRemoved(previous[j].a) || bodies.IsRemoved(previous[j].b))) {
+            ended.push_back(previous[j++]);
+            ++removed;
+        }
+        else if (j == previous.size() || (i < incoming.size() && ManifoldBefore(incoming[i], previous[j]))) {
+            manifolds.push_back(incoming[i++]);
+            ++created;
+        }
+        else if (i == incoming.size() || ManifoldBefore(previous[j], incoming[i])) {
+            ended.push_back(previous[j++]);
+            ++removed;
+        }
+        else {
+            // still touching: fresh geometry, keep the solver state of
+            // the points that are still on the same features
+            ContactManifold m = incoming[i++];
+            const ContactManifold& old = previous[j++];
+            for (int k = 0; k < m.pointCount; ++k) {
+                for (int o = 0; o < old.pointCount; ++o) {
+                    if (old.points[o].id != m.points[k].id) continue;
+                    m.points[k].normalImpulse = old.points[o].normalImpulse;
+                    m.points[k].tangentImpulse = old.points[o].tangentImpulse;
+                    break;
+                }
+            }
+            m.age = old.age + 1;
+            manifolds.push_back(m);
+            ++kept;
+        }
+    }
+}
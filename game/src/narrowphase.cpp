@@ -0,0 +1,684 @@
+#include "fp_mode.h"
+#include "narrowphase.h"
+#include "simd_integrate.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <emmintrin.h>
+#else
+#define SIMD_X86 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#else
+#define TARGET_SSE2
+#endif
+
+using namespace std;
+
+// Section six
+// ------------------------------------------------------------
+// Geometry overlap tests (return penetration + contact normal)
+
+// Circle–Circle
+bool CircleCircleOverlap(Vector2 posA, float radiusA, Vector2 posB, float radiusB,
+    float& penetration, Vector2& normal) {
+    Vector2 ab = Vector2Subtract(posB, posA);
+    float dist = Vector2Length(ab);
+    float target = radiusA + radiusB;
+
+    if (dist <= 0.0001f) {
+        // overlapped almost exactly; choose any normal
+        normal = { 1.0f, 0.0f };
+        penetration = target;
+        return true;
+    }
+    if (dist >= target) return false;
+
+    normal = Vector2Scale(ab, 1.0f / dist);
+    penetration = target - dist;
+    return true;
+}
+
+// AABB–AABB (axis-aligned, centers at position, halfExtents)
+bool AABBAABBOverlap(Vector2 posA, Vector2 halfA, Vector2 posB, Vector2 halfB,
+    float& penetration, Vector2& normal) {
+    Vector2 diff = Vector2Subtract(posB, posA);
+    float overlapX = halfA.x + halfB.x - fabsf(diff.x);
+    float overlapY = halfA.y + halfB.y - fabsf(diff.y);
+
+    if (overlapX <= 0.0f || overlapY <= 0.0f) return false;
+
+    // collision along axis of least penetration
+    if (overlapX < overlapY) {
+        penetration = overlapX;
+        normal = { (diff.x > 0.0f) ? 1.0f : -1.0f, 0.0f };
+    }
+    else {
+        penetration = overlapY;
+        normal = { 0.0f, (diff.y > 0.0f) ? 1.0f : -1.0f };
+    }
+    return true;
+}
+
+// Circle–AABB
+bool CircleAABBOverlap(Vector2 circlePos, float radius, Vector2 boxPos, Vector2 boxHalf,
+    float& penetration, Vector2& normal) {
+    // closest point on AABB to circle center
+    Vector2 diff = Vector2Subtract(circlePos, boxPos);
+    Vector2 clamped = {
+        Clamp(diff.x, -boxHalf.x, boxHalf.x),
+        Clamp(diff.y, -boxHalf.y, boxHalf.y)
+    };
+    Vector2 closest = Vector2Add(boxPos, clamped);
+
+    // IMPORTANT: vector from circle -> closest point on box
+    Vector2 v = Vector2Subtract(closest, circlePos);
+    float dist2 = Vector2LengthSqr(v);
+    float r = radius;
+
+    if (dist2 > r * r) return false;
+
+    float dist = sqrtf(dist2);
+
+    if (dist <= 0.0001f) {
+        // Circle center is inside/on the box – pick a normal from circle to box center
+        Vector2 fallback = Vector2Subtract(boxPos, circlePos);
+        normal = SafeNormalize(fallback, { 0.0f, 1.0f });
+        penetration = r;  // approximate
+        return true;
+    }
+
+    // normal points from circle -> box: the manifold's a -> b when the circle is a
+    // (Collide flips it otherwise), which is what ContactSolver pushes apart along
+    normal = Vector2Scale(v, 1.0f / dist);
+    penetration = r - dist;
+    return true;
+}
+
+// ------------------------------------------------------------
+// Polygons
+
+// Tests with a polygon report points up to this far apart, as negative
+// penetration; the solver lets such points close but not cross. A stack
+// resting face on face then has all its contacts from the first step,
+// instead of each row finding the one below only after sinking into it.
+const float POLYGON_CONTACT_MARGIN = 1.0f;   // px
+
+// Polygon moved into the world: rotated, translated copy of the body-space one
+struct WorldPolygon {
+    int     count;
+    Vector2 v[MAX_POLYGON_VERTICES];
+    Vector2 n[MAX_POLYGON_VERTICES];
+};
+
+static void PlacePolygon(const ConvexPolygon& poly, Vector2 pos, Vector2 rot, WorldPolygon& out) {
+    out.count = poly.count;
+    for (int i = 0; i < poly.count; ++i) {
+        out.v[i] = Vector2Add(pos, Rotate(rot, poly.vertices[i]));
+        out.n[i] = Rotate(rot, poly.normals[i]);
+    }
+}
+
+// Largest separation of b from any face of a (negative = overlap on every face)
+static float MaxSeparation(const WorldPolygon& a, const WorldPolygon& b, int& edge) {
+    float best = -FLT_MAX;
+    edge = 0;
+    for (int i = 0; i < a.count; ++i) {
+        float deepest = FLT_MAX;
+        for (int j = 0; j < b.count; ++j) {
+            deepest = min(deepest, Vector2DotProduct(a.n[i], Vector2Subtract(b.v[j], a.v[i])));
+        }
+        if (deepest > best) {
+            best = deepest;
+            edge = i;
+        }
+    }
+    return best;
+}
+
+// Keeps the part of the segment with dot(normal, p) <= offset. An end
+// that is cut off is replaced in place, so out[k] always comes from in[k]'s
+// end of the segment; that is what contact ids are built from, so they
+// don't change when an end sits right on a side plane.
+static bool ClipSegment(Vector2 out[2], const Vector2 in[2], Vector2 normal, float offset) {
+    float d0 = Vector2DotProduct(normal, in[0]) - offset;
+    float d1 = Vector2DotProduct(normal, in[1]) - offset;
+    if (d0 > 0.0f && d1 > 0.0f) return false;
+    out[0] = in[0];
+    out[1] = in[1];
+    if (d0 * d1 < 0.0f) {
+        Vector2 cut = Vector2Add(in[0], Vector2Scale(Vector2Subtract(in[1], in[0]), d0 / (d0 - d1)));
+        out[(d0 > 0.0f) ? 0 : 1] = cut;
+    }
+    return true;
+}
+
+// Reference face is A's unless B's separates clearly less; the bias keeps
+// the choice from flipping between steps when two faces are about equal
+const float REFERENCE_FACE_REL_TOL = 0.98f;
+const float REFERENCE_FACE_ABS_TOL = 0.5f;   // px
+
+// Face of inc most against the normal n
+static int IncidentEdge(const WorldPolygon& inc, Vector2 n) {
+    int edge = 0;
+    float minDot = FLT_MAX;
+    for (int i = 0; i < inc.count; ++i) {
+        float d = Vector2DotProduct(n, inc.n[i]);
+        if (d < minDot) {
+            minDot = d;
+            edge = i;
+        }
+    }
+    return edge;
+}
+
+// Clips inc's face incEdge against the side planes of the reference face
+// v1 -> v2 (normal n) and keeps the points behind it, or just in front of
+// it. idBase tells the reference faces apart in the point ids.
+static bool ClipToReferenceFace(Vector2 v1, Vector2 v2, Vector2 n, const WorldPolygon& inc, int incEdge,
+    uint32_t idBase, Contact& out) {
+    Vector2 t = { -n.y, n.x };   // along v1 -> v2
+    Vector2 incident[2] = { inc.v[incEdge], inc.v[(incEdge + 1) % inc.count] };
+    Vector2 sideA[2], sideB[2];
+    if (!ClipSegment(sideA, incident, Vector2Negate(t), -Vector2DotProduct(t, v1))) return false;
+    if (!ClipSegment(sideB, sideA, t, Vector2DotProduct(t, v2))) return false;
+
+    const float front = Vector2DotProduct(n, v1);
+    out.pointCount = 0;
+    out.penetration = -FLT_MAX;
+    for (int k = 0; k < 2; ++k) {
+        float separation = Vector2DotProduct(n, sideB[k]) - front;
+        if (separation >= POLYGON_CONTACT_MARGIN) continue;
+        ContactPoint& p = out.points[out.pointCount++];
+        p.position = Vector2Subtract(sideB[k], Vector2Scale(n, 0.5f * separation));
+        p.penetration = -separation;
+        p.id = idBase | ((uint32_t)incEdge << 8) | (uint32_t)k;
+        out.penetration = max(out.penetration, p.penetration);
+    }
+    return out.pointCount > 0;
+}
+
+static bool CollideWorldPolygons(const WorldPolygon& a, const WorldPolygon& b, Contact& out) {
+    int edgeA, edgeB;
+    float sepA = MaxSeparation(a, b, edgeA);
+    if (sepA >= POLYGON_CONTACT_MARGIN) return false;
+    float sepB = MaxSeparation(b, a, edgeB);
+    if (sepB >= POLYGON_CONTACT_MARGIN) return false;
+
+    const WorldPolygon* ref = &a;
+    const WorldPolygon* inc = &b;
+    int refEdge = edgeA;
+    bool flip = false;
+    if (sepB > REFERENCE_FACE_REL_TOL * sepA + REFERENCE_FACE_ABS_TOL) {
+        ref = &b;
+        inc = &a;
+        refEdge = edgeB;
+        flip = true;
+    }
+
+    Vector2 n = ref->n[refEdge];
+    int incEdge = IncidentEdge(*inc, n);
+    uint32_t idBase = ((uint32_t)flip << 24) | ((uint32_t)refEdge << 16);
+    if (!ClipToReferenceFace(ref->v[refEdge], ref->v[(refEdge + 1) % ref->count], n, *inc, incEdge, idBase, out)) {
+        return false;
+    }
+    out.normal = flip ? Vector2Negate(n) : n;
+    return true;
+}
+
+bool PolygonPolygonCollide(const ConvexPolygon& polyA, Vector2 posA, Vector2 rotA,
+    const ConvexPolygon& polyB, Vector2 posB, Vector2 rotB, Contact& out) {
+    WorldPolygon a, b;
+    PlacePolygon(polyA, posA, rotA, a);
+    PlacePolygon(polyB, posB, rotB, b);
+    return CollideWorldPolygons(a, b, out);
+}
+
+// Normal points from the circle to the polygon
+bool CirclePolygonCollide(Vector2 circlePos, float radius,
+    const ConvexPolygon& poly, Vector2 polyPos, Vector2 polyRot, Contact& out) {
+    WorldPolygon p;
+    PlacePolygon(poly, polyPos, polyRot, p);
+
+    // face the center is furthest in front of
+    int face = 0;
+    float separation = -FLT_MAX;
+    for (int i = 0; i < p.count; ++i) {
+        float s = Vector2DotProduct(p.n[i], Vector2Subtract(circlePos, p.v[i]));
+        if (s > radius + POLYGON_CONTACT_MARGIN) return false;
+        if (s > separation) {
+            separation = s;
+            face = i;
+        }
+    }
+
+    Vector2 v1 = p.v[face];
+    Vector2 v2 = p.v[(face + 1) % p.count];
+    Vector2 outward = p.n[face];   // polygon -> circle
+    float dist = separation;
+    uint32_t id = (uint32_t)face;
+
+    // outside the face: the nearest feature may be one of its corners
+    if (separation > 0.0f) {
+        int corner = -1;
+        if (Vector2DotProduct(Vector2Subtract(circlePos, v1), Vector2Subtract(v2, v1)) <= 0.0f) corner = face;
+        else if (Vector2DotProduct(Vector2Subtract(circlePos, v2), Vector2Subtract(v1, v2)) <= 0.0f) corner = (face + 1) % p.count;
+        if (corner >= 0) {
+            Vector2 d = Vector2Subtract(circlePos, p.v[corner]);
+            float len2 = Vector2LengthSqr(d);
+            float reach = radius + POLYGON_CONTACT_MARGIN;
+            if (len2 >= reach * reach) return false;
+            dist = sqrtf(len2);
+            outward = SafeNormalize(d, outward);
+            id = 0x100u | (uint32_t)corner;
+        }
+    }
+
+    out.normal = Vector2Negate(outward);
+    out.penetration = radius - dist;
+    out.pointCount = 1;
+    out.points[0].position = Vector2Subtract(circlePos, Vector2Scale(outward, 0.5f * (radius + dist)));
+    out.points[0].penetration = out.penetration;
+    out.points[0].id = id;
+    return true;
+}
+
+// ------------------------------------------------------------
+// Terrain segments (one-sided, normal out of the ground)
+
+// The segment is always the reference face, so a body sliding along a chain
+// never catches on the end of the next segment, and one that sank in is
+// pushed back out along the normal however deep it went
+bool SegmentPolygonCollide(const TerrainSegment& seg,
+    const ConvexPolygon& poly, Vector2 polyPos, Vector2 polyRot, Contact& out) {
+    WorldPolygon p;
+    PlacePolygon(poly, polyPos, polyRot, p);
+    if (!ClipToReferenceFace(seg.v1, seg.v2, seg.normal, p, IncidentEdge(p, seg.normal), 0, out)) return false;
+    out.normal = seg.normal;
+    return true;
+}
+
+bool SegmentCircleCollide(const TerrainSegment& seg, Vector2 circlePos, float radius, Contact& out) {
+    Vector2 d = Vector2Subtract(circlePos, seg.v1);
+    float separation = Vector2DotProduct(seg.normal, d);
+    if (separation > radius + POLYGON_CONTACT_MARGIN) return false;
+
+    Vector2 e = Vector2Subtract(seg.v2, seg.v1);
+    float along = Vector2DotProduct(d, e);
+    Vector2 outward = seg.normal;   // segment -> circle
+    float dist = separation;
+    uint32_t id = 0;
+
+    // past an end: the end point, seen from in front only, and only where
+    // no face covers it (see TerrainSegment)
+    if (along < 0.0f || along > Vector2LengthSqr(e)) {
+        const bool start = (along < 0.0f);
+        if (separation <= 0.0f || !(start ? seg.startCorner : seg.endCorner)) return false;
+        Vector2 corner = start ? seg.v1 : seg.v2;
+        Vector2 toCenter = Vector2Subtract(circlePos, corner);
+        if (!start && Vector2DotProduct(toCenter, seg.next) > 0.0f) return false;   // the next face's
+        float len2 = Vector2LengthSqr(toCenter);
+        float reach = radius + POLYGON_CONTACT_MARGIN;
+        if (len2 >= reach * reach) return false;
+        dist = sqrtf(len2);
+        outward = SafeNormalize(toCenter, seg.normal);
+        id = start ? 1u : 2u;
+    }
+
+    out.normal = outward;
+    out.penetration = radius - dist;
+    out.pointCount = 1;
+    out.points[0].position = Vector2Subtract(circlePos, Vector2Scale(outward, 0.5f * (radius + dist)));
+    out.points[0].penetration = out.penetration;
+    out.points[0].id = id;
+    return true;
+}
+
+// AABBs take part in polygon tests as boxes (their rotation stays identity)
+static const ConvexPolygon& PolygonOf(const BodyStore& bodies, int i, ConvexPolygon& box) {
+    const BodyShape& s = bodies.shape[i];
+    if (s.type == SHAPE_POLYGON) return bodies.polygons[s.polygon];
+    box = MakeBoxPolygon(s.halfExtents);
+    return box;
+}
+
+// One point for the curved / axis-aligned tests, from their normal and
+// depth: halfway into the overlap along the normal
+static void SetSinglePoint(const BodyStore& bodies, int a, int b, Contact& c) {
+    const BodyShape& sa = bodies.shape[a];
+    const BodyShape& sb = bodies.shape[b];
+    Vector2 pa = bodies.position[a];
+    Vector2 pb = bodies.position[b];
+    ContactPoint& p = c.points[0];
+
+    if (sa.type == SHAPE_CIRCLE) {
+        p.position = Vector2Add(pa, Vector2Scale(c.normal, sa.radius - 0.5f * c.penetration));
+    }
+    else if (sb.type == SHAPE_CIRCLE) {
+        p.position = Vector2Subtract(pb, Vector2Scale(c.normal, sb.radius - 0.5f * c.penetration));
+    }
+    else {
+        // two AABBs: middle of the overlap rectangle
+        float x0 = max(pa.x - sa.halfExtents.x, pb.x - sb.halfExtents.x);
+        float x1 = min(pa.x + sa.halfExtents.x, pb.x + sb.halfExtents.x);
+        float y0 = max(pa.y - sa.halfExtents.y, pb.y - sb.halfExtents.y);
+        float y1 = min(pa.y + sa.halfExtents.y, pb.y + sb.halfExtents.y);
+        p.position = { 0.5f * (x0 + x1), 0.5f * (y0 + y1) };
+    }
+    p.penetration = c.penetration;
+    p.id = 0;
+    c.pointCount = 1;
+}
+
+// One body against one terrain segment; normal points from the segment to the body
+static bool BodySegmentCollide(const BodyStore& bodies, int i, const TerrainSegment& seg, Contact& out) {
+    const BodyShape& s = bodies.shape[i];
+    if (s.type == SHAPE_CIRCLE) {
+        return SegmentCircleCollide(seg, bodies.position[i], s.radius, out);
+    }
+    ConvexPolygon box;
+    return SegmentPolygonCollide(seg, PolygonOf(bodies, i, box), bodies.position[i], bodies.rotation[i], out);
+}
+
+// Shape dispatch for one body pair; normal always points a -> b
+bool BodiesOverlap(const BodyStore& bodies, int a, int b, Contact& out) {
+    const BodyShape& sa = bodies.shape[a];
+    const BodyShape& sb = bodies.shape[b];
+    Vector2 pa = bodies.position[a];
+    Vector2 pb = bodies.position[b];
+
+    if (sa.type == SHAPE_POLYGON || sb.type == SHAPE_POLYGON) {
+        ConvexPolygon boxA, boxB;
+        if (sa.type == SHAPE_CIRCLE) {
+            return CirclePolygonCollide(pa, sa.radius, PolygonOf(bodies, b, boxB), pb, bodies.rotation[b], out);
+        }
+        if (sb.type == SHAPE_CIRCLE) {
+            if (!CirclePolygonCollide(pb, sb.radius, PolygonOf(bodies, a, boxA), pa, bodies.rotation[a], out)) return false;
+            out.normal = Vector2Negate(out.normal); // flip to a->b
+            return true;
+        }
+        return PolygonPolygonCollide(PolygonOf(bodies, a, boxA), pa, bodies.rotation[a],
+            PolygonOf(bodies, b, boxB), pb, bodies.rotation[b], out);
+    }
+
+    bool hit;
+    if (sa.type == SHAPE_CIRCLE && sb.type == SHAPE_CIRCLE) {
+        hit = CircleCircleOverlap(pa, sa.radius, pb, sb.radius, out.penetration, out.normal);
+    }
+    else if (sa.type == SHAPE_AABB && sb.type == SHAPE_AABB) {
+        hit = AABBAABBOverlap(pa, sa.halfExtents, pb, sb.halfExtents, out.penetration, out.normal);
+    }
+    else if (sa.type == SHAPE_CIRCLE) {
+        hit = CircleAABBOverlap(pa, sa.radius, pb, sb.halfExtents, out.penetration, out.normal);
+    }
+    else {
+        hit = CircleAABBOverlap(pb, sb.radius, pa, sa.halfExtents, out.penetration, out.normal);
+        if (hit) out.normal = Vector2Scale(out.normal, -1.0f); // flip to a->b
+    }
+    if (hit) SetSinglePoint(bodies, a, b, out);
+    return hit;
+}
+
+// ------------------------------------------------------------
+// SSE2 batch kernels: 4 pairs per call, same operation order as the
+// scalar tests above so results match bit-for-bit.
+
+#if SIMD_X86
+
+struct Lanes4 {
+    alignas(16) float v[4];
+};
+
+TARGET_SSE2 static inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+TARGET_SSE2 static void CircleCircle4(const BodyStore& bodies, const vector<BodyPair>& pairs, const int* idx,
+    uint8_t* hit, Contact* out) {
+    Lanes4 ax, ay, bx, by, ra, rb;
+    for (int k = 0; k < 4; ++k) {
+        const BodyPair& p = pairs[idx[k]];
+        ax.v[k] = bodies.position[p.a].x;  ay.v[k] = bodies.position[p.a].y;
+        bx.v[k] = bodies.position[p.b].x;  by.v[k] = bodies.position[p.b].y;
+        ra.v[k] = bodies.shape[p.a].radius;
+        rb.v[k] = bodies.shape[p.b].radius;
+    }
+
+    __m128 abx = _mm_sub_ps(_mm_load_ps(bx.v), _mm_load_ps(ax.v));
+    __m128 aby = _mm_sub_ps(_mm_load_ps(by.v), _mm_load_ps(ay.v));
+    __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(abx, abx), _mm_mul_ps(aby, aby)));
+    __m128 target = _mm_add_ps(_mm_load_ps(ra.v), _mm_load_ps(rb.v));
+
+    __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), dist);
+    __m128 nx = _mm_mul_ps(abx, inv);
+    __m128 ny = _mm_mul_ps(aby, inv);
+    __m128 depth = _mm_sub_ps(target, dist);
+
+    // overlapped almost exactly: any normal, full penetration
+    __m128 degenerate = _mm_cmple_ps(dist, _mm_set1_ps(0.0001f));
+    nx = Select(degenerate, _mm_set1_ps(1.0f), nx);
+    ny = Select(degenerate, _mm_setzero_ps(), ny);
+    depth = Select(degenerate, target, depth);
+    __m128 touching = _mm_or_ps(degenerate, _mm_cmplt_ps(dist, target));
+
+    Lanes4 outX, outY, outPen;
+    _mm_store_ps(outX.v, nx);
+    _mm_store_ps(outY.v, ny);
+    _mm_store_ps(outPen.v, depth);
+    int mask = _mm_movemask_ps(touching);
+    for (int k = 0; k < 4; ++k) {
+        hit[idx[k]] = (mask >> k) & 1;
+        out[idx[k]].penetration = outPen.v[k];
+        out[idx[k]].normal = { outX.v[k], outY.v[k] };
+    }
+}
+
+TARGET_SSE2 static void CircleBox4(const BodyStore& bodies, const vector<BodyPair>& pairs, const int* idx,
+    uint8_t* hit, Contact* out) {
+    Lanes4 cx, cy, r, bx, by, hx, hy, flip;
+    for (int k = 0; k < 4; ++k) {
+        const BodyPair& p = pairs[idx[k]];
+        bool circleIsA = (bodies.shape[p.a].type == SHAPE_CIRCLE);
+        int c = circleIsA ? p.a : p.b;
+        int b = circleIsA ? p.b : p.a;
+        cx.v[k] = bodies.position[c].x;  cy.v[k] = bodies.position[c].y;
+        bx.v[k] = bodies.position[b].x;  by.v[k] = bodies.position[b].y;
+        r.v[k] = bodies.shape[c].radius;
+        hx.v[k] = bodies.shape[b].halfExtents.x;
+        hy.v[k] = bodies.shape[b].halfExtents.y;
+        flip.v[k] = circleIsA ? 0.0f : -0.0f;  // sign bit flips the normal to a->b
+    }
+
+    __m128 vcx = _mm_load_ps(cx.v), vcy = _mm_load_ps(cy.v);
+    __m128 vbx = _mm_load_ps(bx.v), vby = _mm_load_ps(by.v);
+    __m128 vhx = _mm_load_ps(hx.v), vhy = _mm_load_ps(hy.v);
+    __m128 radius = _mm_load_ps(r.v);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    // closest point on the box to the circle center
+    __m128 dx = _mm_sub_ps(vcx, vbx);
+    __m128 dy = _mm_sub_ps(vcy, vby);
+    __m128 clx = _mm_min_ps(_mm_max_ps(dx, _mm_xor_ps(vhx, signBit)), vhx);
+    __m128 cly = _mm_min_ps(_mm_max_ps(dy, _mm_xor_ps(vhy, signBit)), vhy);
+    __m128 vx = _mm_sub_ps(_mm_add_ps(vbx, clx), vcx);
+    __m128 vy = _mm_sub_ps(_mm_add_ps(vby, cly), vcy);
+
+    __m128 dist2 = _mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy));
+    __m128 touching = _mm_cmple_ps(dist2, _mm_mul_ps(radius, radius));
+    __m128 dist = _mm_sqrt_ps(dist2);
+
+    __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), dist);
+    __m128 nx = _mm_mul_ps(vx, inv);
+    __m128 ny = _mm_mul_ps(vy, inv);
+    __m128 depth = _mm_sub_ps(radius, dist);
+
+    // center inside the box: normal from circle to box center (SafeNormalize)
+    __m128 fx = _mm_sub_ps(vbx, vcx);
+    __m128 fy = _mm_sub_ps(vby, vcy);
+    __m128 flen = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(fx, fx), _mm_mul_ps(fy, fy)));
+    __m128 finv = _mm_div_ps(_mm_set1_ps(1.0f), flen);
+    __m128 fok = _mm_cmpgt_ps(flen, _mm_set1_ps(1e-6f));
+    __m128 fnx = Select(fok, _mm_mul_ps(fx, finv), _mm_setzero_ps());
+    __m128 fny = Select(fok, _mm_mul_ps(fy, finv), _mm_set1_ps(1.0f));
+
+    __m128 degenerate = _mm_cmple_ps(dist, _mm_set1_ps(0.0001f));
+    nx = Select(degenerate, fnx, nx);
+    ny = Select(degenerate, fny, ny);
+    depth = Select(degenerate, radius, depth);
+
+    __m128 sign = _mm_load_ps(flip.v);
+    nx = _mm_xor_ps(nx, sign);
+    ny = _mm_xor_ps(ny, sign);
+
+    Lanes4 outX, outY, outPen;
+    _mm_store_ps(outX.v, nx);
+    _mm_store_ps(outY.v, ny);
+    _mm_store_ps(outPen.v, depth);
+    int mask = _mm_movemask_ps(touching);
+    for (int k = 0; k < 4; ++k) {
+        hit[idx[k]] = (mask >> k) & 1;
+        out[idx[k]].penetration = outPen.v[k];
+        out[idx[k]].normal = { outX.v[k], outY.v[k] };
+    }
+}
+
+TARGET_SSE2 static void BoxBox4(const BodyStore& bodies, const vector<BodyPair>& pairs, const int* idx,
+    uint8_t* hit, Contact* out) {
+    Lanes4 ax, ay, bx, by, hax, hay, hbx, hby;
+    for (int k = 0; k < 4; ++k) {
+        const BodyPair& p = pairs[idx[k]];
+        ax.v[k] = bodies.position[p.a].x;  ay.v[k] = bodies.position[p.a].y;
+        bx.v[k] = bodies.position[p.b].x;  by.v[k] = bodies.position[p.b].y;
+        hax.v[k] = bodies.shape[p.a].halfExtents.x;  hay.v[k] = bodies.shape[p.a].halfExtents.y;
+        hbx.v[k] = bodies.shape[p.b].halfExtents.x;  hby.v[k] = bodies.shape[p.b].halfExtents.y;
+    }
+
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    __m128 dx = _mm_sub_ps(_mm_load_ps(bx.v), _mm_load_ps(ax.v));
+    __m128 dy = _mm_sub_ps(_mm_load_ps(by.v), _mm_load_ps(ay.v));
+    __m128 ox = _mm_sub_ps(_mm_add_ps(_mm_load_ps(hax.v), _mm_load_ps(hbx.v)), _mm_andnot_ps(signBit, dx));
+    __m128 oy = _mm_sub_ps(_mm_add_ps(_mm_load_ps(hay.v), _mm_load_ps(hby.v)), _mm_andnot_ps(signBit, dy));
+    __m128 touching = _mm_and_ps(_mm_cmpgt_ps(ox, zero), _mm_cmpgt_ps(oy, zero));
+
+    // axis of least penetration, normal sign from the center offset
+    __m128 useX = _mm_cmplt_ps(ox, oy);
+    __m128 sx = Select(_mm_cmpgt_ps(dx, zero), one, _mm_xor_ps(one, signBit));
+    __m128 sy = Select(_mm_cmpgt_ps(dy, zero), one, _mm_xor_ps(one, signBit));
+
+    Lanes4 outX, outY, outPen;
+    _mm_store_ps(outX.v, Select(useX, sx, zero));
+    _mm_store_ps(outY.v, Select(useX, zero, sy));
+    _mm_store_ps(outPen.v, Select(useX, ox, oy));
+    int mask = _mm_movemask_ps(touching);
+    for (int k = 0; k < 4; ++k) {
+        hit[idx[k]] = (mask >> k) & 1;
+        out[idx[k]].penetration = outPen.v[k];
+        out[idx[k]].normal = { outX.v[k], outY.v[k] };
+    }
+}
+
+#endif // SIMD_X86
+
+// ------------------------------------------------------------
+// Batch driver
+
+void Narrowphase::Collide(const BodyStore& bodies, const vector<BodyPair>& pairs, vector<Contact>& contacts) {
+    const int n = (int)pairs.size();
+    pairsTested = n;
+    simdBatches = 0;
+
+    hit.assign(n, 0);
+    result.resize(n);
+
+    int scalarFrom = 0; // pairs before this index were handled by SIMD batches
+
+#if SIMD_X86
+    if (GetSimdLevel() >= SIMD_SSE2) {
+        circleCircle.clear();
+        circleBox.clear();
+        boxBox.clear();
+        polygonPairs.clear();
+        for (int i = 0; i < n; ++i) {
+            ShapeType ta = bodies.shape[pairs[i].a].type;
+            ShapeType tb = bodies.shape[pairs[i].b].type;
+            bool ca = (ta == SHAPE_CIRCLE);
+            bool cb = (tb == SHAPE_CIRCLE);
+            if (ta == SHAPE_POLYGON || tb == SHAPE_POLYGON) polygonPairs.push_back(i);
+            else if (ca && cb)  circleCircle.push_back(i);
+            else if (ca || cb)  circleBox.push_back(i);
+            else                boxBox.push_back(i);
+        }
+
+        // full batches go through the lanes, leftovers through the scalar tests;
+        // lanes only give normal + depth, the point is added when compacting
+        auto runBatches = [&](const vector<int>& list,
+            void (*kernel)(const BodyStore&, const vector<BodyPair>&, const int*, uint8_t*, Contact*)) {
+            size_t i = 0;
+            for (; i + 4 <= list.size(); i += 4) {
+                kernel(bodies, pairs, &list[i], hit.data(), result.data());
+                for (int k = 0; k < 4; ++k) result[list[i + k]].pointCount = 0;
+                ++simdBatches;
+            }
+            for (; i < list.size(); ++i) {
+                int p = list[i];
+                hit[p] = BodiesOverlap(bodies, pairs[p].a, pairs[p].b, result[p]) ? 1 : 0;
+            }
+        };
+        runBatches(circleCircle, CircleCircle4);
+        runBatches(circleBox, CircleBox4);
+        runBatches(boxBox, BoxBox4);
+        for (int p : polygonPairs) {
+            hit[p] = BodiesOverlap(bodies, pairs[p].a, pairs[p].b, result[p]) ? 1 : 0;
+        }
+        scalarFrom = n;
+    }
+#endif
+
+    for (int i = scalarFrom; i < n; ++i) {
+        hit[i] = BodiesOverlap(bodies, pairs[i].a, pairs[i].b, result[i]) ? 1 : 0;
+    }
+
+    // compact in pair order
+    size_t first = contacts.size();
+    for (int i = 0; i < n; ++i) {
+        if (!hit[i]) continue;
+        Contact c = result[i];
+        c.a = pairs[i].a;
+        c.b = pairs[i].b;
+        if (c.pointCount == 0) SetSinglePoint(bodies, c.a, c.b, c);
+        contacts.push_back(c);
+    }
+    contactCount = (int)(contacts.size() - first);
+}
+
+void Narrowphase::CollideTerrain(const BodyStore& bodies, const Terrain& terrain, const vector<int>& chainBodies,
+    const vector<BroadphaseProxy>& proxies, vector<Contact>& contacts) {
+    segmentsTested = 0;
+    size_t first = contacts.size();
+    for (const BroadphaseProxy& proxy : proxies) {
+        if (proxy.isStatic) continue;
+        const int b = proxy.body;
+        terrain.Query(proxy.box, [&](int segment) {
+            const TerrainSegment& seg = terrain.segments[segment];
+            const int a = (seg.chain < (int)chainBodies.size()) ? chainBodies[seg.chain] : -1;
+            if (a < 0) return;
+            ++segmentsTested;
+            Contact c;
+            if (!BodySegmentCollide(bodies, b, seg, c)) return;
+            c.a = a;
+            c.b = b;
+            c.child = (uint32_t)segment;
+            contacts.push_back(c);
+        });
+    }
+    terrainContactCount = (int)(contacts.size() - first);
+}
@@ -0,0 +1,110 @@
+#include "fp_mode.h"
+#include "polygon.h"
+#include "raymath.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+Vector2 RotationFromAngle(float radians) {
+    return { cosf(radians), sinf(radians) };
+}
+
+float AngleOf(Vector2 rot) {
+    return atan2f(rot.y, rot.x);
+}
+
+static inline float Cross(Vector2 o, Vector2 a, Vector2 b) {
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+// Normals and bounding radius from the (centered) vertices
+static void FinishPolygon(ConvexPolygon& poly) {
+    poly.radius = 0.0f;
+    for (int i = 0; i < poly.count; ++i) {
+        Vector2 e = Vector2Subtract(poly.vertices[(i + 1) % poly.count], poly.vertices[i]);
+        poly.normals[i] = Vector2Normalize({ e.y, -e.x });
+        poly.radius = max(poly.radius, Vector2Length(poly.vertices[i]));
+    }
+}
+
+bool BuildPolygon(const Vector2* points, int count, ConvexPolygon& out, Vector2* centroid) {
+    if (count < 3 || count > MAX_POLYGON_VERTICES) return false;
+
+    // (1) hull, monotone chain: lower then upper, collinear points dropped
+    Vector2 sorted[MAX_POLYGON_VERTICES];
+    copy(points, points + count, sorted);
+    sort(sorted, sorted + count, [](const Vector2& l, const Vector2& r) {
+        return (l.x < r.x) || (l.x == r.x && l.y < r.y);
+    });
+
+    Vector2 hull[2 * MAX_POLYGON_VERTICES];
+    int h = 0;
+    for (int i = 0; i < count; ++i) {
+        while (h >= 2 && Cross(hull[h - 2], hull[h - 1], sorted[i]) <= 0.0f) --h;
+        hull[h++] = sorted[i];
+    }
+    for (int i = count - 2, lower = h + 1; i >= 0; --i) {
+        while (h >= lower && Cross(hull[h - 2], hull[h - 1], sorted[i]) <= 0.0f) --h;
+        hull[h++] = sorted[i];
+    }
+    --h;   // the last point repeats the first
+    if (h < 3) return false;
+
+    // (2) area and centroid (fan from the first vertex)
+    float area = 0.0f;
+    Vector2 center{ 0.0f, 0.0f };
+    for (int i = 1; i + 1 < h; ++i) {
+        float tri = 0.5f * Cross(hull[0], hull[i], hull[i + 1]);
+        area += tri;
+        Vector2 sum = Vector2Add(Vector2Add(hull[0], hull[i]), hull[i + 1]);
+        center = Vector2Add(center, Vector2Scale(sum, tri / 3.0f));
+    }
+    if (area <= 1e-3f) return false;
+    center = Vector2Scale(center, 1.0f / area);
+
+    out.count = h;
+    for (int i = 0; i < h; ++i) out.vertices[i] = Vector2Subtract(hull[i], center);
+    FinishPolygon(out);
+    if (centroid) *centroid = center;
+    return true;
+}
+
+ConvexPolygon MakeBoxPolygon(Vector2 half) {
+    ConvexPolygon poly;
+    poly.count = 4;
+    poly.vertices[0] = { -half.x, -half.y };
+    poly.vertices[1] = { half.x, -half.y };
+    poly.vertices[2] = { half.x, half.y };
+    poly.vertices[3] = { -half.x, half.y };
+    poly.normals[0] = { 0.0f, -1.0f };
+    poly.normals[1] = { 1.0f, 0.0f };
+    poly.normals[2] = { 0.0f, 1.0f };
+    poly.normals[3] = { -1.0f, 0.0f };
+    poly.radius = Vector2Length(half);
+    return poly;
+}
+
+// Second moment of area over the triangles (origin, v[i], v[i+1])
+float PolygonInertia(const ConvexPolygon& poly, float mass) {
+    float area = 0.0f, second = 0.0f;
+    for (int i = 0; i < poly.count; ++i) {
+        Vector2 e1 = poly.vertices[i];
+        Vector2 e2 = poly.vertices[(i + 1) % poly.count];
+        float d = e1.x * e2.y - e1.y * e2.x;
+        area += 0.5f * d;
+        float xx = e1.x * e1.x + e2.x * e1.x + e2.x * e2.x;
+        float yy = e1.y * e1.y + e2.y * e1.y + e2.y * e2.y;
+        second += (d / 12.0f) * (xx + yy);
+    }
+    return (area > 0.0f) ? mass * second / area : 0.0f;
+}
+
+bool SamePolygon(const ConvexPolygon& a, const ConvexPolygon& b) {
+    if (a.count != b.count) return false;
+    for (int i = 0; i < a.count; ++i) {
+        if (a.vertices[i].x != b.vertices[i].x || a.vertices[i].y != b.vertices[i].y) return false;
+    }
+    return true;
+}
@@ -0,0 +1,112 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+using namespace std;
+
+Profiler profiler;
+
+static const char* const phaseNames[PHASE_COUNT] = {
+    "integrate", "broadphase", "narrowphase", "solve", "sleep", "draw"
+};
+
+const char* ProfilePhaseName(ProfilePhase phase) {
+    return (phase >= 0 && phase < PHASE_COUNT) ? phaseNames[phase] : "?";
+}
+
+int64_t ProfileNowNs() {
+    using namespace std::chrono;
+    return (int64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ------------------------------------------------------------
+
+void Profiler::Record(ProfilePhase phase, int64_t startNs, int64_t endNs) {
+    if (!enabled) return;
+    frameTotal[phase] += endNs - startNs;
+
+    if (tracing) {
+        if ((int)events.size() < maxTraceEvents) events.push_back({ startNs, endNs - startNs, (int)phase });
+        else ++droppedEvents;
+    }
+}
+
+void Profiler::EndFrame() {
+    if (!enabled) return;
+
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+        history[p][head] = (double)frameTotal[p];
+        frameTotal[p] = 0;
+    }
+    head = (head + 1) % HISTORY;
+    count = min(count + 1, HISTORY);
+
+    // frame spans end to end, so gaps between frames show up in the trace too
+    int64_t now = ProfileNowNs();
+    if (tracing) {
+        if ((int)events.size() < maxTraceEvents) events.push_back({ frameStart, now - frameStart, PHASE_COUNT });
+        else ++droppedEvents;
+    }
+    frameStart = now;
+}
+
+double Profiler::Sample(ProfilePhase phase, int age) const {
+    if (age < 0 || age >= count) return 0.0;
+    return history[phase][(head - 1 - age + HISTORY) % HISTORY];
+}
+
+double Profiler::Last(ProfilePhase phase) const {
+    return Sample(phase, 0);
+}
+
+double Profiler::Average(ProfilePhase phase) const {
+    if (count == 0) return 0.0;
+    double sum = 0.0;
+    for (int i = 0; i < count; ++i) sum += Sample(phase, i);
+    return sum / count;
+}
+
+double Profiler::Percentile(ProfilePhase phase, double p) const {
+    if (count == 0) return 0.0;
+    double sorted[HISTORY];
+    for (int i = 0; i < count; ++i) sorted[i] = Sample(phase, i);
+
+    int k = min(count - 1, (int)(p * count));
+    nth_element(sorted, sorted + k, sorted + count);
+    return sorted[k];
+}
+
+// ------------------------------------------------------------
+// Trace capture
+
+void Profiler::StartTrace() {
+    events.clear();
+    droppedEvents = 0;
+    traceStart = ProfileNowNs();
+    frameStart = traceStart;
+    tracing = true;
+}
+
+// Complete ("X") events in microseconds; one track for the phases and one
+// for whole frames, so spikes line up with the phase that caused them.
+bool Profiler::StopTrace(const char* path) {
+    tracing = false;
+
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"phases\"}},\n");
+    fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"frames\"}}");
+    for (const TraceEvent& e : events) {
+        bool frame = (e.phase == PHASE_COUNT);
+        fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+            frame ? "frame" : phaseNames[e.phase], frame ? 2 : 1,
+            (e.start - traceStart) * 1e-3, e.duration * 1e-3);
+    }
+    fprintf(f, "\n]}\n");
+    fclose(f);
+    return true;
+}
@@ -0,0 +1,149 @@
+#include "replay.h"
+#include "simulation.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+// ------------------------------------------------------------
+// Tunables (toggles are stored as 0 / 1)
+
+struct Tunable {
+    const char* name;
+    float*      value;
+    bool*       flag;
+};
+
+static const Tunable tunables[] = {
+    { "gravity",     &gravityAcc,          nullptr },
+    { "restitution", &globalRestitution,   nullptr },
+    { "friction",    &globalFrictionCoeff, nullptr },
+    { "toughness",   &pigToughness,        nullptr },
+    { "iterations",  &solverIterations,    nullptr },
+    { "hz",          &physicsHz,           nullptr },
+    { "ccd",         nullptr,              &ccdEnabled },
+    { "coloring",    nullptr,              &contactSolver.graphColoring },
+};
+
+int TunableCount() {
+    return (int)(sizeof(tunables) / sizeof(tunables[0]));
+}
+
+const char* TunableName(int index) {
+    return (index >= 0 && index < TunableCount()) ? tunables[index].name : "?";
+}
+
+int FindTunable(const char* name) {
+    for (int i = 0; i < TunableCount(); ++i) {
+        if (strcmp(tunables[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+float GetTunable(int index) {
+    const Tunable& t = tunables[index];
+    return t.value ? *t.value : (*t.flag ? 1.0f : 0.0f);
+}
+
+void SetTunable(int index, float value) {
+    const Tunable& t = tunables[index];
+    if (t.value) *t.value = value;
+    else         *t.flag = (value != 0.0f);
+    if (t.value == &physicsHz && physicsHz > 0.0f) dt = 1.0f / physicsHz;
+}
+
+// ------------------------------------------------------------
+// Replay scripts
+
+bool LoadReplayScript(const char* path, vector<ReplayEvent>& out) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "%s: can't open\n", path);
+        return false;
+    }
+
+    char line[256];
+    int lineNo = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f)) {
+        ++lineNo;
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        char name[32] = "", type[16] = "";
+        ReplayEvent e;
+        if (sscanf(line, " %31s", name) != 1) continue;   // blank line
+
+        if (sscanf(line, "%u set %31s %f", &e.step, name, &e.value) == 3) {
+            e.kind = REPLAY_SET;
+            e.tunable = FindTunable(name);
+            if (e.tunable < 0) {
+                fprintf(stderr, "%s:%d: unknown setting '%s'\n", path, lineNo, name);
+                ok = false;
+            }
+        }
+        else if (sscanf(line, "%u explode %f %f %f %f", &e.step, &e.position.x, &e.position.y, &e.radius, &e.strength) == 5) {
+            e.kind = REPLAY_EXPLODE;
+        }
+        else if (sscanf(line, "%u %f %f %15s", &e.step, &e.velocity.x, &e.velocity.y, type) >= 3) {
+            e.kind = REPLAY_LAUNCH;
+            e.birdType = (strcmp(type, "square") == 0) ? 1 : 0;
+        }
+        else {
+            fprintf(stderr, "%s:%d: expected \"step vx vy [circle|square]\", \"step set name value\" or \"step explode x y radius strength\"\n", path, lineNo);
+            ok = false;
+        }
+        if (ok) out.push_back(e);
+    }
+    fclose(f);
+    return ok;
+}
+
+bool SaveReplayScript(const char* path, const vector<ReplayEvent>& events) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+
+    fprintf(f, "# step vx vy [circle|square]  |  step set name value  |  step explode x y radius strength\n");
+    for (const ReplayEvent& e : events) {
+        if (e.kind == REPLAY_SET) {
+            fprintf(f, "%u set %s %.9g\n", e.step, TunableName(e.tunable), e.value);
+        }
+        else if (e.kind == REPLAY_EXPLODE) {
+            fprintf(f, "%u explode %.9g %.9g %.9g %.9g\n", e.step, e.position.x, e.position.y, e.radius, e.strength);
+        }
+        else {
+            fprintf(f, "%u %.9g %.9g %s\n", e.step, e.velocity.x, e.velocity.y, e.birdType ? "square" : "circle");
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+// ------------------------------------------------------------
+// Hash logs
+
+bool SaveHashLog(const char* path, const vector<uint64_t>& hashes) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        fprintf(f, "%zu %016" PRIx64 "\n", i, hashes[i]);
+    }
+    fclose(f);
+    return true;
+}
+
+bool LoadHashLog(const char* path, vector<uint64_t>& out) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+
+    unsigned long step;
+    uint64_t hash;
+    while (fscanf(f, "%lu %" SCNx64, &step, &hash) == 2) {
+        if (step != out.size()) break;   // steps must run 0, 1, 2, ...
+        out.push_back(hash);
+    }
+    fclose(f);
+    return true;
+}
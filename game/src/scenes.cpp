@@ -0,0 +1,246 @@
+#include "fp_mode.h"
+#include "scenes.h"
+#include "simulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+// Small deterministic generator (same sequence on every platform, unlike rand())
+struct SceneRandom {
+    uint32_t state;
+
+    explicit SceneRandom(uint32_t seed) : state(seed ? seed : 1u) {}
+
+    uint32_t Next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    float Range(float lo, float hi) {
+        return lo + (hi - lo) * (float)(Next() >> 8) * (1.0f / 16777216.0f);
+    }
+};
+
+static const char* const sceneNames[SCENE_COUNT] = { "pyramids", "ballpit", "forts", "debris", "hills" };
+
+const char* SceneName(SceneKind kind) {
+    return (kind >= 0 && kind < SCENE_COUNT) ? sceneNames[kind] : "?";
+}
+
+bool ParseScene(const char* name, SceneKind& out) {
+    for (int i = 0; i < SCENE_COUNT; ++i) {
+        if (strcmp(name, sceneNames[i]) == 0) {
+            out = (SceneKind)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ------------------------------------------------------------
+// Generators
+
+// Pyramids of 10x10 half-extent blocks, 20 at the base (210 each),
+// side by side; the last one is cut short to hit the count.
+static void BuildPyramids(int count) {
+    const int base = 20;
+    const Vector2 half{ 10.0f, 10.0f };
+    const float pitch = half.x * 2.2f;
+    const float width = base * pitch + 80.0f;
+    const int perPyramid = base * (base + 1) / 2;
+    const int pyramids = max(1, (count + perPyramid - 1) / perPyramid);
+
+    worldWidth = pyramids * width + 200.0f;
+    ClearWorld();
+
+    int placed = 0;
+    for (int p = 0; p < pyramids && placed < count; ++p) {
+        float left = 100.0f + p * width;
+        for (int row = 0; row < base && placed < count; ++row) {
+            for (int x = 0; x < base - row && placed < count; ++x) {
+                Vector2 pos = {
+                    left + (x + row * 0.5f) * pitch + half.x,
+                    groundY - half.y - row * (half.y * 2.05f)
+                };
+                bodies.Add(MakeBox(OBJ_BLOCK, pos, half, 4.0f, BROWN));
+                ++placed;
+            }
+        }
+    }
+}
+
+// Pits 60 balls wide with static walls between them; balls start in a
+// loose grid just above the floor, jittered so they don't stack in columns.
+static void BuildBallPit(int count) {
+    const int cols = 60;
+    const int rowsPerPit = 10;
+    const float radius = 8.0f;
+    const float pitch = radius * 2.1f;
+    const float pitWidth = cols * pitch;
+    const Vector2 wallHalf{ 6.0f, rowsPerPit * pitch * 0.75f };
+    const int perPit = cols * rowsPerPit;
+    const int pits = max(1, (count + perPit - 1) / perPit);
+
+    worldWidth = pits * (pitWidth + wallHalf.x * 2.0f) + 200.0f;
+    ClearWorld();
+
+    SceneRandom rng(0xBA11u);
+    float left = 100.0f;
+    int placed = 0;
+    for (int p = 0; p < pits; ++p) {
+        Body wall = MakeAABB(OBJ_STATIC_TERRAIN, { left + wallHalf.x, groundY - wallHalf.y }, wallHalf, 0.0f, DARKGRAY);
+        bodies.Add(wall);
+        left += wallHalf.x * 2.0f;
+
+        for (int i = 0; i < perPit && placed < count; ++i, ++placed) {
+            int row = i / cols, col = i % cols;
+            Vector2 pos = {
+                left + (col + 0.5f) * pitch + rng.Range(-0.5f, 0.5f),
+                groundY - radius - 1.0f - row * pitch
+            };
+            bodies.Add(MakeCircle(OBJ_BLOCK, pos, radius, 1.0f, ORANGE));
+        }
+        left += pitWidth;
+    }
+    Body wall = MakeAABB(OBJ_STATIC_TERRAIN, { left + wallHalf.x, groundY - wallHalf.y }, wallHalf, 0.0f, DARKGRAY);
+    bodies.Add(wall);
+}
+
+// The BuildWorld fort (25x25 blocks, a pig on top) with the column and
+// row count varying from fort to fort, plus a pig on the ground beside it.
+static void BuildForts(int count) {
+    const Vector2 half{ 25.0f, 25.0f };
+    const float pitch = half.x * 2.2f;
+    const float gap = 120.0f;
+
+    // count the forts first so the ground can be sized
+    float width = 100.0f;
+    for (int placed = 0, f = 0; placed < count; ++f) {
+        int cols = 2 + f % 3, rows = 3 + f % 4;
+        placed += cols * rows + 2;
+        width += cols * pitch + gap;
+    }
+    worldWidth = width + 100.0f;
+    ClearWorld();
+
+    float left = 100.0f;
+    int placed = 0;
+    for (int f = 0; placed < count; ++f) {
+        int cols = 2 + f % 3, rows = 3 + f % 4;
+        Vector2 basePos = { left + half.x, groundY - half.y };
+
+        for (int y = 0; y < rows && placed < count; ++y) {
+            for (int x = 0; x < cols && placed < count; ++x, ++placed) {
+                Vector2 pos = { basePos.x + x * pitch, basePos.y - y * (half.y * 2.05f) };
+                bodies.Add(MakeBox(OBJ_BLOCK, pos, half, 4.0f, BROWN));
+            }
+        }
+
+        if (placed < count) {
+            Vector2 top = { basePos.x + (cols - 1) * pitch * 0.5f, basePos.y - rows * (half.y * 2.1f) - 20.0f };
+            bodies.Add(MakeCircle(OBJ_PIG, top, 15.0f, 1.5f, GREEN));
+            ++placed;
+        }
+        if (placed < count) {
+            Vector2 beside = { left + cols * pitch + gap * 0.5f, groundY - 15.0f };
+            bodies.Add(MakeCircle(OBJ_PIG, beside, 15.0f, 1.5f, GREEN));
+            ++placed;
+        }
+
+        left += cols * pitch + gap;
+    }
+}
+
+// About one body per 160x160 px, mixed tilted blocks and circles with small random
+// velocities: lots of falling, few contacts until they land.
+static void BuildDebris(int count) {
+    const float spacing = 160.0f;
+    const int cols = max(4, (int)ceilf(sqrtf((float)count * 2.0f)));
+    const int rows = (count + cols - 1) / cols;
+
+    worldWidth = cols * spacing + 200.0f;
+    ClearWorld();
+
+    SceneRandom rng(0xDEB215u);
+    for (int i = 0; i < count; ++i) {
+        int row = i / cols, col = i % cols;
+        Vector2 pos = {
+            100.0f + (col + rng.Range(0.1f, 0.9f)) * spacing,
+            groundY - 40.0f - (rows - row - 1 + rng.Range(0.1f, 0.9f)) * spacing
+        };
+
+        Body b;
+        if (rng.Next() % 5 < 3) {
+            Vector2 half{ rng.Range(4.0f, 12.0f), rng.Range(4.0f, 12.0f) };
+            b = MakeBox(OBJ_BLOCK, pos, half, half.x * half.y * 0.04f, BROWN, rng.Range(-PI, PI));
+        }
+        else {
+            float r = rng.Range(4.0f, 10.0f);
+            b = MakeCircle(OBJ_BLOCK, pos, r, r * r * 0.04f, GRAY);
+        }
+        b.velocity = { rng.Range(-50.0f, 50.0f), rng.Range(-50.0f, 50.0f) };
+        bodies.Add(b);
+    }
+}
+
+// Rolling hills as one terrain chain with a point every 8 px (thousands of
+// segments in a big scene), and blocks and circles dropped onto them from
+// columns of four: they land on the slopes, then slide and roll downhill.
+static void BuildHills(int count) {
+    const float spacing = 30.0f;
+    const int perColumn = 4;
+    const int columns = max(8, (count + perColumn - 1) / perColumn);
+
+    worldWidth = columns * spacing + 200.0f;
+    ClearWorld();
+
+    // highest point 160 px above the ground, lowest 20 px
+    const float step = 8.0f;
+    const int pointCount = (int)(worldWidth / step) + 1;
+    vector<Vector2> points(pointCount);
+    for (int k = 0; k < pointCount; ++k) {
+        float x = k * step;
+        points[k] = { x, groundY - 90.0f - 50.0f * sinf(x * 0.004f) - 20.0f * sinf(x * 0.013f + 1.0f) };
+    }
+    int chain = terrain.AddChain(points.data(), pointCount);
+    bodies.Add(MakeChain(terrain, chain, DARKGREEN));
+    terrain.Build();
+
+    SceneRandom rng(0x4111u);
+    for (int i = 0; i < count; ++i) {
+        int col = i / perColumn, layer = i % perColumn;
+        Vector2 pos = {
+            100.0f + (col + 0.5f) * spacing + rng.Range(-4.0f, 4.0f),
+            groundY - 200.0f - layer * spacing
+        };
+
+        Body b;
+        if (rng.Next() % 5 < 3) {
+            Vector2 half{ rng.Range(5.0f, 10.0f), rng.Range(5.0f, 10.0f) };
+            b = MakeBox(OBJ_BLOCK, pos, half, half.x * half.y * 0.04f, BROWN, rng.Range(-PI, PI));
+        }
+        else {
+            float r = rng.Range(5.0f, 9.0f);
+            b = MakeCircle(OBJ_BLOCK, pos, r, r * r * 0.04f, GRAY);
+        }
+        bodies.Add(b);
+    }
+}
+
+void BuildScene(SceneKind kind, int bodyCount) {
+    bodyCount = max(bodyCount, 0);
+    switch (kind) {
+    case SCENE_PYRAMIDS: BuildPyramids(bodyCount); break;
+    case SCENE_BALL_PIT: BuildBallPit(bodyCount);  break;
+    case SCENE_FORTS:    BuildForts(bodyCount);    break;
+    case SCENE_DEBRIS:   BuildDebris(bodyCount);   break;
+    case SCENE_HILLS:    BuildHills(bodyCount);    break;
+    default:             ClearWorld();             break;
+    }
+}
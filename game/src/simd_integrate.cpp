@@ -0,0 +1,338 @@
+#include "fp_mode.h"
+#include "simd_integrate.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define SIMD_X86 0
+#endif
+
+// GCC/Clang only emit AVX2 inside functions that ask for it; MSVC always can
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+// ------------------------------------------------------------
+// Scalar reference (also handles the tail of the SIMD loops)
+
+static void IntegrateScalar(Vector2* position, Vector2* velocity, const float* invMass,
+    const uint8_t* active, int begin, int end, float gravity, float dt) {
+    const float gdt = gravity * dt;
+    for (int i = begin; i < end; ++i) {
+        if (!active[i]) continue;
+        if (invMass[i] == 0.0f) continue; // static
+
+        position[i].x += velocity[i].x * dt;
+        position[i].y += velocity[i].y * dt;
+        velocity[i].y += gdt;
+    }
+}
+
+static void DampScalar(Vector2* velocity, const float* invMass, const uint8_t* active,
+    int begin, int end, float eps) {
+    for (int i = begin; i < end; ++i) {
+        if (!active[i] || invMass[i] == 0.0f) continue;
+        if (fabsf(velocity[i].x) < eps && fabsf(velocity[i].y) < eps) {
+            velocity[i] = { 0.0f, 0.0f };
+        }
+    }
+}
+
+static void IntegrateRotationsScalar(Vector2* rotation, const float* angularVelocity, const float* invInertia,
+    const uint8_t* active, int begin, int end, float dt) {
+    for (int i = begin; i < end; ++i) {
+        if (!active[i] || invInertia[i] == 0.0f) continue;
+
+        float a = angularVelocity[i] * dt;
+        float x = rotation[i].x - a * rotation[i].y;
+        float y = rotation[i].y + a * rotation[i].x;
+        float inv = 1.0f / sqrtf(x * x + y * y);
+        rotation[i] = { x * inv, y * inv };
+    }
+}
+
+#if SIMD_X86
+
+// ------------------------------------------------------------
+// SSE2: 4 bodies per iteration. Vector2 arrays are interleaved (x, y), so
+// the per-body mask [m0 m1 m2 m3] is widened to [m0 m0 m1 m1] / [m2 m2 m3 m3].
+// Gravity is added as (-0, g*dt): adding -0 leaves x bit-for-bit unchanged.
+
+TARGET_SSE2 static inline __m128 BodyMask4(const float* invMass, const uint8_t* active) {
+    const __m128i zeroi = _mm_setzero_si128();
+    __m128 dynamic = _mm_cmpneq_ps(_mm_loadu_ps(invMass), _mm_setzero_ps());
+
+    int bytes;
+    memcpy(&bytes, active, 4);
+    __m128i a = _mm_cvtsi32_si128(bytes);
+    a = _mm_unpacklo_epi8(a, zeroi);
+    a = _mm_unpacklo_epi16(a, zeroi);
+    __m128 isActive = _mm_castsi128_ps(_mm_cmpgt_epi32(a, zeroi));
+
+    return _mm_and_ps(dynamic, isActive);
+}
+
+TARGET_SSE2 static inline __m128 Select4(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+TARGET_SSE2 static void IntegrateSSE2(Vector2* position, Vector2* velocity, const float* invMass,
+    const uint8_t* active, int count, float gravity, float dt) {
+    const __m128 g = _mm_set_ps(gravity * dt, -0.0f, gravity * dt, -0.0f);
+    const __m128 step = _mm_set1_ps(dt);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 m = BodyMask4(invMass + i, active + i);
+        __m128 m01 = _mm_unpacklo_ps(m, m);
+        __m128 m23 = _mm_unpackhi_ps(m, m);
+
+        float* v = (float*)(velocity + i);
+        float* p = (float*)(position + i);
+
+        __m128 v01 = _mm_loadu_ps(v);
+        __m128 v23 = _mm_loadu_ps(v + 4);
+        __m128 p01 = _mm_loadu_ps(p);
+        __m128 p23 = _mm_loadu_ps(p + 4);
+
+        __m128 np01 = _mm_add_ps(p01, _mm_mul_ps(v01, step));
+        __m128 np23 = _mm_add_ps(p23, _mm_mul_ps(v23, step));
+        __m128 nv01 = _mm_add_ps(v01, g);
+        __m128 nv23 = _mm_add_ps(v23, g);
+
+        _mm_storeu_ps(v, Select4(m01, nv01, v01));
+        _mm_storeu_ps(v + 4, Select4(m23, nv23, v23));
+        _mm_storeu_ps(p, Select4(m01, np01, p01));
+        _mm_storeu_ps(p + 4, Select4(m23, np23, p23));
+    }
+    IntegrateScalar(position, velocity, invMass, active, i, count, gravity, dt);
+}
+
+TARGET_SSE2 static void DampSSE2(Vector2* velocity, const float* invMass, const uint8_t* active,
+    int count, float eps) {
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128 limit = _mm_set1_ps(eps);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 m = BodyMask4(invMass + i, active + i);
+        __m128 m01 = _mm_unpacklo_ps(m, m);
+        __m128 m23 = _mm_unpackhi_ps(m, m);
+
+        float* v = (float*)(velocity + i);
+        __m128 v01 = _mm_loadu_ps(v);
+        __m128 v23 = _mm_loadu_ps(v + 4);
+
+        // |v| < eps per lane, then x AND y within each body
+        __m128 c01 = _mm_cmplt_ps(_mm_andnot_ps(signBit, v01), limit);
+        __m128 c23 = _mm_cmplt_ps(_mm_andnot_ps(signBit, v23), limit);
+        c01 = _mm_and_ps(c01, _mm_shuffle_ps(c01, c01, _MM_SHUFFLE(2, 3, 0, 1)));
+        c23 = _mm_and_ps(c23, _mm_shuffle_ps(c23, c23, _MM_SHUFFLE(2, 3, 0, 1)));
+
+        _mm_storeu_ps(v, _mm_andnot_ps(_mm_and_ps(c01, m01), v01));
+        _mm_storeu_ps(v + 4, _mm_andnot_ps(_mm_and_ps(c23, m23), v23));
+    }
+    DampScalar(velocity, invMass, active, i, count, eps);
+}
+
+// Rotations are split into x / y lanes, updated, and interleaved back
+TARGET_SSE2 static void IntegrateRotationsSSE2(Vector2* rotation, const float* angularVelocity, const float* invInertia,
+    const uint8_t* active, int count, float dt) {
+    const __m128 step = _mm_set1_ps(dt);
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 m = BodyMask4(invInertia + i, active + i);
+        float* r = (float*)(rotation + i);
+        __m128 r01 = _mm_loadu_ps(r);
+        __m128 r23 = _mm_loadu_ps(r + 4);
+        __m128 x = _mm_shuffle_ps(r01, r23, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 y = _mm_shuffle_ps(r01, r23, _MM_SHUFFLE(3, 1, 3, 1));
+
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(angularVelocity + i), step);
+        __m128 nx = _mm_sub_ps(x, _mm_mul_ps(a, y));
+        __m128 ny = _mm_add_ps(y, _mm_mul_ps(a, x));
+        __m128 inv = _mm_div_ps(one, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny))));
+        nx = Select4(m, _mm_mul_ps(nx, inv), x);
+        ny = Select4(m, _mm_mul_ps(ny, inv), y);
+
+        _mm_storeu_ps(r, _mm_unpacklo_ps(nx, ny));
+        _mm_storeu_ps(r + 4, _mm_unpackhi_ps(nx, ny));
+    }
+    IntegrateRotationsScalar(rotation, angularVelocity, invInertia, active, i, count, dt);
+}
+
+// ------------------------------------------------------------
+// AVX2: 8 bodies per iteration, same scheme on 256-bit registers.
+// unpacklo/hi work per 128-bit half, so a permute puts bodies 0-3 and 4-7 back together.
+
+TARGET_AVX2 static inline __m256 BodyMask8(const float* invMass, const uint8_t* active) {
+    __m256 dynamic = _mm256_cmp_ps(_mm256_loadu_ps(invMass), _mm256_setzero_ps(), _CMP_NEQ_UQ);
+    __m256i a = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)active));
+    __m256 isActive = _mm256_castsi256_ps(_mm256_cmpgt_epi32(a, _mm256_setzero_si256()));
+    return _mm256_and_ps(dynamic, isActive);
+}
+
+TARGET_AVX2 static inline void WidenMask8(__m256 m, __m256& m0123, __m256& m4567) {
+    __m256 lo = _mm256_unpacklo_ps(m, m);   // m0 m0 m1 m1 | m4 m4 m5 m5
+    __m256 hi = _mm256_unpackhi_ps(m, m);   // m2 m2 m3 m3 | m6 m6 m7 m7
+    m0123 = _mm256_permute2f128_ps(lo, hi, 0x20);
+    m4567 = _mm256_permute2f128_ps(lo, hi, 0x31);
+}
+
+TARGET_AVX2 static void IntegrateAVX2(Vector2* position, Vector2* velocity, const float* invMass,
+    const uint8_t* active, int count, float gravity, float dt) {
+    const float gdt = gravity * dt;
+    const __m256 g = _mm256_set_ps(gdt, -0.0f, gdt, -0.0f, gdt, -0.0f, gdt, -0.0f);
+    const __m256 step = _mm256_set1_ps(dt);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 m0123, m4567;
+        WidenMask8(BodyMask8(invMass + i, active + i), m0123, m4567);
+
+        float* v = (float*)(velocity + i);
+        float* p = (float*)(position + i);
+
+        __m256 va = _mm256_loadu_ps(v);
+        __m256 vb = _mm256_loadu_ps(v + 8);
+        __m256 pa = _mm256_loadu_ps(p);
+        __m256 pb = _mm256_loadu_ps(p + 8);
+
+        __m256 npa = _mm256_add_ps(pa, _mm256_mul_ps(va, step));
+        __m256 npb = _mm256_add_ps(pb, _mm256_mul_ps(vb, step));
+        __m256 nva = _mm256_add_ps(va, g);
+        __m256 nvb = _mm256_add_ps(vb, g);
+
+        _mm256_storeu_ps(v, _mm256_blendv_ps(va, nva, m0123));
+        _mm256_storeu_ps(v + 8, _mm256_blendv_ps(vb, nvb, m4567));
+        _mm256_storeu_ps(p, _mm256_blendv_ps(pa, npa, m0123));
+        _mm256_storeu_ps(p + 8, _mm256_blendv_ps(pb, npb, m4567));
+    }
+    IntegrateScalar(position, velocity, invMass, active, i, count, gravity, dt);
+}
+
+TARGET_AVX2 static void DampAVX2(Vector2* velocity, const float* invMass, const uint8_t* active,
+    int count, float eps) {
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+    const __m256 limit = _mm256_set1_ps(eps);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 m0123, m4567;
+        WidenMask8(BodyMask8(invMass + i, active + i), m0123, m4567);
+
+        float* v = (float*)(velocity + i);
+        __m256 va = _mm256_loadu_ps(v);
+        __m256 vb = _mm256_loadu_ps(v + 8);
+
+        __m256 ca = _mm256_cmp_ps(_mm256_andnot_ps(signBit, va), limit, _CMP_LT_OQ);
+        __m256 cb = _mm256_cmp_ps(_mm256_andnot_ps(signBit, vb), limit, _CMP_LT_OQ);
+        ca = _mm256_and_ps(ca, _mm256_permute_ps(ca, _MM_SHUFFLE(2, 3, 0, 1)));
+        cb = _mm256_and_ps(cb, _mm256_permute_ps(cb, _MM_SHUFFLE(2, 3, 0, 1)));
+
+        _mm256_storeu_ps(v, _mm256_andnot_ps(_mm256_and_ps(ca, m0123), va));
+        _mm256_storeu_ps(v + 8, _mm256_andnot_ps(_mm256_and_ps(cb, m4567), vb));
+    }
+    DampScalar(velocity, invMass, active, i, count, eps);
+}
+
+#endif // SIMD_X86
+
+// ------------------------------------------------------------
+// Runtime dispatch
+
+SimdLevel DetectSimdLevel() {
+#if SIMD_X86
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6) { // OS saves ymm state
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    bool sse2 = __builtin_cpu_supports("sse2");
+    bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    if (avx2) return SIMD_AVX2;
+    if (sse2) return SIMD_SSE2;
+#endif
+    return SIMD_SCALAR;
+}
+
+static SimdLevel activeLevel = DetectSimdLevel();
+
+SimdLevel GetSimdLevel() {
+    return activeLevel;
+}
+
+void SetSimdLevel(SimdLevel level) {
+    SimdLevel best = DetectSimdLevel();
+    activeLevel = (level > best) ? best : level;
+}
+
+const char* SimdLevelName(SimdLevel level) {
+    switch (level) {
+    case SIMD_SCALAR: return "Scalar";
+    case SIMD_SSE2:   return "SSE2";
+    case SIMD_AVX2:   return "AVX2";
+    default:          return "?";
+    }
+}
+
+void IntegrateBodies(Vector2* position, Vector2* velocity, const float* invMass,
+    const uint8_t* active, int count, float gravity, float dt) {
+#if SIMD_X86
+    if (activeLevel == SIMD_AVX2) { IntegrateAVX2(position, velocity, invMass, active, count, gravity, dt); return; }
+    if (activeLevel == SIMD_SSE2) { IntegrateSSE2(position, velocity, invMass, active, count, gravity, dt); return; }
+#endif
+    IntegrateScalar(position, velocity, invMass, active, 0, count, gravity, dt);
+}
+
+void DampSmallVelocities(Vector2* velocity, const float* invMass,
+    const uint8_t* active, int count, float eps) {
+#if SIMD_X86
+    if (activeLevel == SIMD_AVX2) { DampAVX2(velocity, invMass, active, count, eps); return; }
+    if (activeLevel == SIMD_SSE2) { DampSSE2(velocity, invMass, active, count, eps); return; }
+#endif
+    DampScalar(velocity, invMass, active, 0, count, eps);
+}
+
+void IntegrateRotations(Vector2* rotation, const float* angularVelocity, const float* invInertia,
+    const uint8_t* active, int count, float dt) {
+#if SIMD_X86
+    if (activeLevel >= SIMD_SSE2) { IntegrateRotationsSSE2(rotation, angularVelocity, invInertia, active, count, dt); return; }
+#endif
+    IntegrateRotationsScalar(rotation, angularVelocity, invInertia, active, 0, count, dt);
+}
+
+// One float per body: plain loop at every level
+void DampSmallAngularVelocities(float* angularVelocity, const float* invInertia,
+    const uint8_t* active, int count, float eps) {
+    for (int i = 0; i < count; ++i) {
+        if (!active[i] || invInertia[i] == 0.0f) continue;
+        if (fabsf(angularVelocity[i]) < eps) angularVelocity[i] = 0.0f;
+    }
+}
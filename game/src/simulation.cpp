@@ -0,0 +1,688 @@
+#include "fp_mode.h"
+#include "simulation.h"
+#include "raymath.h"
+#include "simd_integrate.h"
+#include "level.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+// ------------------------------------------------------------
+// Simulation parameters
+float timeElapsed = 0.0f;
+float dt = 0.0f;
+
+// World constants
+const float CONTACT_BAUMGARTE = 0.05f;  // share of the overlap pushed out per step
+const float CONTACT_SLOP = 0.5f;  // px of overlap left alone
+const float BROADPHASE_MARGIN = 2.0f;  // px of padding on broadphase boxes
+const float REST_VEL_EPS = 0.02f;  // slower than this on both axes -> clamped to rest
+const float REST_SPIN_EPS = 0.001f;  // rad/s; slower spin -> clamped to rest
+const float TERRAIN_RESTITUTION = 0.2f;  // ground and terrain chains
+const float TERRAIN_FRICTION = 0.9f;
+const float LOST_BODY_MARGIN = 2000.0f;  // px outside the world (sides, below the ground) before a body is removed
+
+// Removed bodies are packed out of the arrays once they make up this share
+// of the store, or at the latest this many steps after the first removal
+const int COMPACT_FRACTION = 32;   // 1/32
+const int COMPACT_MAX_STEPS = 30;
+static int stepsSinceRemoval = 0;
+
+// ------------------ Adjustable via GUI ------------------
+float gravityAcc = 600.0f;
+float globalRestitution = 0.25f;
+float globalFrictionCoeff = 0.60f;
+float pigToughness = 250.0f;
+float solverIterations = 8.0f;
+float physicsHz = 50.0f;
+
+// ------------------------------------------------------------
+// World
+
+BodyStore bodies;
+BodyHandle lastBird;
+
+Vector2 slingAnchor{ 200.0f, 550.0f };    // fixed slingshot pivot
+float groundY = 700.0f;
+float worldWidth = 1200.0f;
+
+// Chains of static ground segments (hills); their BVH is built at level load
+Terrain terrain;
+static vector<int> chainBodies;   // chain -> its body index, refreshed every step
+
+// Broadphase (B cycles the mode so they can be compared live)
+BroadphaseMode broadphaseMode = BROADPHASE_GRID;
+UniformGrid broadphaseGrid;
+SweepAndPrune broadphaseSap;
+TreeBroadphase broadphaseTree;
+vector<BroadphaseProxy> broadphaseProxies;
+vector<BodyPair> candidatePairs;
+
+// Region queries read the broadphase as the last step left it. That stops
+// lining up with the bodies once the world is replaced between steps or the
+// mode is switched; until the next step they then scan proxies rebuilt
+// from the current bodies instead.
+static bool broadphaseStale = true;
+static BroadphaseMode queryMode = BROADPHASE_BRUTE_FORCE;
+
+// Static bodies (invMass == 0) live in their own BVH, rebuilt only when the
+// static set changes; they are never broadphase proxies themselves
+StaticBodyIndex staticIndex;
+static uint32_t staticIndexVersion = ~0u;
+static vector<int> staticBodies;
+static vector<AABB> staticBoxes;
+
+// Explosions waiting for the next step (ApplyRadialImpulse)
+struct RadialImpulse {
+    Vector2 center;
+    float   radius;
+    float   strength;
+};
+static vector<RadialImpulse> radialImpulses;
+static vector<vector<int>> radialHits;     // per queued explosion
+const int RADIAL_IMPULSES_PER_JOB = 4;     // explosions queried per job
+
+// Narrowphase output, consumed by the contact solver
+Narrowphase narrowphase;
+vector<Contact> contacts;
+
+// Persistent contact manifolds (matched across steps by body-pair key)
+ManifoldCache manifoldCache;
+
+// What happened between touching bodies, for the game to react to after the step
+ContactEventStream contactEvents;
+static uint64_t pigDamageCursor = 0;
+ContactSolver contactSolver;
+
+// Islands + sleeping
+IslandManager islands;
+static float lastGravityAcc = 0.0f;   // gravity the sleeping bodies settled under
+
+// Worker threads for island solves and grid cells
+JobSystem jobs;
+
+// Continuous collision for fast birds
+ContinuousCollision ccd;
+bool ccdEnabled = true;
+
+// Lockstep recording
+bool deterministicMode = false;
+uint32_t stepIndex = 0;
+vector<uint64_t> stepHashes;
+vector<ReplayEvent> replayEvents;
+static vector<float> recordedTunables;   // last value written to replayEvents
+
+// Section two
+// ------------------------------------------------------------
+// Body creation helpers
+
+Body MakeCircle(ObjectType type, Vector2 pos, float radius, float mass, Color color) {
+    Body b;
+    b.position = pos;
+    b.velocity = { 0.0f, 0.0f };
+    b.radius = radius;
+    b.halfExtents = { radius, radius }; // just for convenience
+    b.mass = mass;
+    b.invMass = (mass > 0.0f) ? 1.0f / mass : 0.0f;
+    b.invInertia = (mass > 0.0f) ? 2.0f / (mass * radius * radius) : 0.0f;   // I = m r^2 / 2
+    b.restitution = globalRestitution;
+    b.friction = globalFrictionCoeff;
+    b.shape = SHAPE_CIRCLE;
+    b.type = type;
+    b.color = color;
+    b.active = true;
+    b.alive = true;
+    b.toughness = (type == OBJ_PIG) ? pigToughness : 0.0f;
+    return b;
+}
+
+Body MakeAABB(ObjectType type, Vector2 pos, Vector2 halfExtents, float mass, Color color) {
+    Body b;
+    b.position = pos;
+    b.velocity = { 0.0f, 0.0f };
+    b.radius = max(halfExtents.x, halfExtents.y); // handy for debug
+    b.halfExtents = halfExtents;
+    b.mass = mass;
+    b.invMass = (mass > 0.0f) ? 1.0f / mass : 0.0f;
+    b.restitution = globalRestitution;
+    b.friction = globalFrictionCoeff;
+    b.shape = SHAPE_AABB;
+    b.type = type;
+    b.color = color;
+    b.active = true;
+    b.alive = true;
+    b.toughness = (type == OBJ_PIG) ? pigToughness : 0.0f;
+    return b;
+}
+
+// Rotating convex polygon; the body ends up at the polygon's centroid
+static Body MakePolygonBody(ObjectType type, Vector2 pos, const ConvexPolygon& poly, float mass, Color color, float angle) {
+    Body b;
+    b.position = pos;
+    b.velocity = { 0.0f, 0.0f };
+    b.angle = angle;
+    b.polygon = poly;
+    b.radius = poly.radius;
+    b.halfExtents = { 0.0f, 0.0f };
+    for (int i = 0; i < poly.count; ++i) {
+        b.halfExtents.x = max(b.halfExtents.x, fabsf(poly.vertices[i].x));
+        b.halfExtents.y = max(b.halfExtents.y, fabsf(poly.vertices[i].y));
+    }
+    b.mass = mass;
+    b.invMass = (mass > 0.0f) ? 1.0f / mass : 0.0f;
+    float inertia = PolygonInertia(poly, mass);
+    b.invInertia = (inertia > 0.0f) ? 1.0f / inertia : 0.0f;
+    b.restitution = globalRestitution;
+    b.friction = globalFrictionCoeff;
+    b.shape = SHAPE_POLYGON;
+    b.type = type;
+    b.color = color;
+    b.active = true;
+    b.alive = true;
+    b.toughness = (type == OBJ_PIG) ? pigToughness : 0.0f;
+    return b;
+}
+
+// Static body standing in for a terrain chain: its box around the points,
+// ground material
+Body MakeChain(const Terrain& t, int chain, Color color) {
+    const AABB& box = t.chains[chain].box;
+    Body b = MakeAABB(OBJ_STATIC_TERRAIN, Vector2Scale(Vector2Add(box.min, box.max), 0.5f),
+        Vector2Scale(Vector2Subtract(box.max, box.min), 0.5f), 0.0f, color);
+    b.shape = SHAPE_CHAIN;
+    b.chain = chain;
+    b.restitution = TERRAIN_RESTITUTION;
+    b.friction = TERRAIN_FRICTION;
+    return b;
+}
+
+Body MakeBox(ObjectType type, Vector2 pos, Vector2 halfExtents, float mass, Color color, float angle) {
+    return MakePolygonBody(type, pos, MakeBoxPolygon(halfExtents), mass, color, angle);
+}
+
+Body MakePolygon(ObjectType type, Vector2 pos, const Vector2* points, int count, float mass, Color color, float angle) {
+    ConvexPolygon poly;
+    Vector2 centroid{ 0.0f, 0.0f };
+    if (!BuildPolygon(points, count, poly, &centroid)) {
+        Body b;   // polygon.count == 0 marks the failure
+        b.position = pos;
+        b.shape = SHAPE_POLYGON;
+        b.active = false;
+        return b;
+    }
+    // the points are given unrotated around pos
+    Vector2 center = Vector2Add(pos, Rotate(RotationFromAngle(angle), centroid));
+    return MakePolygonBody(type, center, poly, mass, color, angle);
+}
+
+// Section seven
+// ------------------------------------------------------------
+// Collision response: impulses + friction in ContactSolver, pig toughness
+// from the contact events once the step is solved
+
+// Pig toughness check over this step's contact events (pre-solve momenta),
+// for contacts that actually pushed (normal impulse). A pig killed here took part in this step's solve, so its last
+// interaction pushed things; it leaves the world right after.
+static void ApplyPigDamage() {
+    contactEvents.Read(pigDamageCursor, [](const ContactEvent& e) {
+        if (e.type == CONTACT_END) return;
+        if (e.normalImpulse <= 0.0f) return;   // a near miss: manifolds start a little before touching
+        int a = e.indexA, b = e.indexB;
+        if (!bodies.active[a] || !bodies.active[b]) return;
+
+        BodyGameData& ga = bodies.game[a];
+        BodyGameData& gb = bodies.game[b];
+        if (!ga.alive || !gb.alive)   return;
+
+	// Section eight
+        // approximate "total momentum magnitude" as |m1 v1 - m2 v2|
+        if (ga.type == OBJ_PIG && e.relativeMomentum > ga.toughness) ga.alive = false;
+        if (gb.type == OBJ_PIG && e.relativeMomentum > gb.toughness) gb.alive = false;
+    });
+}
+
+static void RemoveDeadPigs() {
+    for (int i = 0; i < bodies.Count(); ++i) {
+        if (bodies.active[i] && !bodies.game[i].alive) bodies.RemoveAt(i);
+    }
+}
+
+// Section three
+// ------------------------------------------------------------
+// World setup
+
+// Empty world: just the ground (big static AABB)
+void ClearWorld() {
+    bodies.Clear();
+    terrain.Clear();
+    lastBird = BodyHandle();
+    manifoldCache.Clear();
+    contactEvents.Clear();
+    radialImpulses.clear();
+    InvalidateBroadphase();
+    stepsSinceRemoval = 0;
+
+    stepIndex = 0;
+    stepHashes.clear();
+    replayEvents.clear();
+    recordedTunables.clear();   // the first step records every tunable
+
+    // top face at groundY, where scenes and levels put things down
+    Vector2 half = { worldWidth, 40.0f };
+    Vector2 pos = { worldWidth * 0.5f, groundY + half.y };
+    Body ground = MakeAABB(OBJ_STATIC_TERRAIN, pos, half, 0.0f, DARKGREEN);
+    ground.restitution = TERRAIN_RESTITUTION;
+    ground.friction = TERRAIN_FRICTION;
+    bodies.Add(ground);
+}
+
+// Default fort in the level text format (see level.h): 3 x 4 blocks near
+// the right side, one pig on top and one inside
+static const char* const DEFAULT_FORT =
+    "grid 3 4 55 -51.25\n"
+    "block 795 675 25 25 4 brown\n"
+    "pig 850 445 15 1.5\n"
+    "pig 850 600 15 1.5\n";
+
+void BuildWorld() {
+    LoadLevelText(DEFAULT_FORT, "default fort");
+}
+
+// Create a bird at the slingshot anchor
+void SpawnBird(const Vector2& velocity, int birdType) {
+    Body bird;
+    if (birdType == 0) {
+        // Circular light bird
+        bird = MakeCircle(OBJ_BIRD, slingAnchor, 12.0f, 1.0f, YELLOW);
+    }
+    else {
+        // Square heavy bird
+        bird = MakeBox(OBJ_BIRD, slingAnchor, { 14.0f, 14.0f }, 4.0f, RED);
+    }
+    bird.velocity = velocity;
+    lastBird = bodies.Add(bird);
+
+    if (deterministicMode) {
+        ReplayEvent e;
+        e.step = stepIndex;
+        e.kind = REPLAY_LAUNCH;
+        e.velocity = velocity;
+        e.birdType = birdType;
+        replayEvents.push_back(e);
+    }
+}
+
+void ApplyRadialImpulse(Vector2 center, float radius, float strength) {
+    if (radius <= 0.0f) return;
+    radialImpulses.push_back({ center, radius, strength });
+
+    if (deterministicMode) {
+        ReplayEvent e;
+        e.step = stepIndex;
+        e.kind = REPLAY_EXPLODE;
+        e.position = center;
+        e.radius = radius;
+        e.strength = strength;
+        replayEvents.push_back(e);
+    }
+}
+
+// Section five
+// ------------------------------------------------------------
+// Physics update
+
+// World-space bounds used by the broadphase. Padded a little so pairs that
+// only start touching later in this step still get tested.
+static AABB BoundsAt(int i, Vector2 pos) {
+    Vector2 lo, hi;
+    bodies.LocalBounds(i, lo, hi);
+    AABB box;
+    box.min = Vector2SubtractValue(Vector2Add(pos, lo), BROADPHASE_MARGIN);
+    box.max = Vector2AddValue(Vector2Add(pos, hi), BROADPHASE_MARGIN);
+    return box;
+}
+
+static AABB BodyBounds(int i) {
+    return BoundsAt(i, bodies.position[i]);
+}
+
+// Fast bodies get a box around their whole step, so anything they could
+// have passed through this step shows up as a candidate pair
+static AABB SweptBounds(int i) {
+    AABB box = BodyBounds(i);
+    if (!ccd.IsFast(i)) return box;
+
+    AABB from = BoundsAt(i, ccd.start[i]);
+    box.min = Vector2Min(box.min, from.min);
+    box.max = Vector2Max(box.max, from.max);
+    return box;
+}
+
+// Static bodies don't move, so their boxes from the last rebuild stay good
+// until one is added, removed or compacted to another index
+static void UpdateStaticIndex() {
+    if (staticIndexVersion == bodies.StaticVersion()) return;
+    staticIndexVersion = bodies.StaticVersion();
+
+    staticBodies.clear();
+    staticBoxes.clear();
+    for (int i = 0; i < bodies.Count(); ++i) {
+        if (!bodies.active[i] || bodies.invMass[i] != 0.0f || bodies.shape[i].type == SHAPE_CHAIN) continue;
+        staticBodies.push_back(i);
+        staticBoxes.push_back(BodyBounds(i));
+    }
+    staticIndex.Build(staticBodies, staticBoxes);
+}
+
+// Contact generation: broadphase -> narrowphase -> manifold cache.
+// Only reads body state; nothing is pushed apart until ResolveContacts.
+static void GenerateContacts() {
+    const int n = bodies.Count();
+
+    // Broadphase: bounding boxes of moving bodies -> candidate pairs.
+    // Terrain chains and static bodies stay out; awake bodies find them in
+    // the terrain BVH and the static index.
+    {
+        PROFILE_SCOPE(PHASE_BROADPHASE);
+        UpdateStaticIndex();
+        broadphaseProxies.clear();
+        chainBodies.assign(terrain.ChainCount(), -1);
+        for (int i = 0; i < n; ++i) {
+            if (!bodies.active[i]) continue;
+            if (bodies.shape[i].type == SHAPE_CHAIN) {
+                int chain = bodies.shape[i].chain;
+                if (chain >= 0 && chain < terrain.ChainCount()) chainBodies[chain] = i;
+                continue;
+            }
+            if (bodies.invMass[i] == 0.0f) continue;
+
+            BroadphaseProxy proxy;
+            proxy.box = SweptBounds(i);
+            proxy.body = i;
+            proxy.isStatic = !bodies.awake[i];   // sleepers never pair with each other
+            broadphaseProxies.push_back(proxy);
+        }
+
+        candidatePairs.clear();
+        switch (broadphaseMode) {
+        case BROADPHASE_GRID: broadphaseGrid.FindPairs(broadphaseProxies, candidatePairs, &jobs); break;
+        case BROADPHASE_SAP:  broadphaseSap.FindPairs(broadphaseProxies, candidatePairs);  break;
+        case BROADPHASE_TREE: broadphaseTree.FindPairs(broadphaseProxies, candidatePairs); break;
+        default:              BruteForcePairs(broadphaseProxies, candidatePairs);          break;
+        }
+        staticIndex.FindPairs(broadphaseProxies, candidatePairs);
+        queryMode = broadphaseMode;
+        broadphaseStale = false;
+    }
+
+    PROFILE_SCOPE(PHASE_NARROWPHASE);
+
+    // Continuous pass: fast bodies are pulled back to their first impact
+    ccd.Sweep(bodies, candidatePairs, terrain, chainBodies);
+
+    // Narrowphase: batched shape tests -> contact buffer (kept in pair order)
+    contacts.clear();
+    narrowphase.Collide(bodies, candidatePairs, contacts);
+    narrowphase.CollideTerrain(bodies, terrain, chainBodies, broadphaseProxies, contacts);
+
+    // Match against last step's manifolds (created / kept / removed)
+    manifoldCache.Update(bodies, contacts);
+}
+
+// Contact resolution over the cached manifolds, in pair-key order
+static void ResolveContacts() {
+    PROFILE_SCOPE(PHASE_SOLVE);
+    contactEvents.Prepare(bodies, manifoldCache.manifolds);
+
+    contactSolver.velocityIterations = (int)solverIterations;
+    contactSolver.baumgarte = CONTACT_BAUMGARTE;
+    contactSolver.penetrationSlop = CONTACT_SLOP;
+    contactSolver.timeStep = dt;
+    contactSolver.Solve(bodies, manifoldCache.manifolds, islands, &jobs);
+
+    contactEvents.Publish(bodies, manifoldCache.manifolds, manifoldCache.ended, stepIndex);
+    ApplyPigDamage();
+    RemoveDeadPigs();
+}
+
+// Append a "set" event for every tunable that changed since the last step
+static void RecordTunableChanges() {
+    const int count = TunableCount();
+    if ((int)recordedTunables.size() != count) recordedTunables.assign(count, NAN);
+
+    for (int i = 0; i < count; ++i) {
+        float value = GetTunable(i);
+        if (value == recordedTunables[i]) continue;   // NaN never matches
+        ReplayEvent e;
+        e.step = stepIndex;
+        e.kind = REPLAY_SET;
+        e.tunable = i;
+        e.value = value;
+        replayEvents.push_back(e);
+        recordedTunables[i] = value;
+    }
+}
+
+// Birds that flew off the side of the world or fell past the ground would
+// otherwise be integrated forever
+static void RemoveLostBodies() {
+    const float left = -0.5f * worldWidth - LOST_BODY_MARGIN;
+    const float right = 1.5f * worldWidth + LOST_BODY_MARGIN;
+    const float bottom = groundY + LOST_BODY_MARGIN;
+    for (int i = 0; i < bodies.Count(); ++i) {
+        if (!bodies.awake[i] || bodies.invMass[i] == 0.0f) continue;
+        const Vector2 p = bodies.position[i];
+        if (p.x < left || p.x > right || p.y > bottom) bodies.RemoveAt(i);
+    }
+}
+
+// Periodic compaction: removed bodies leave the arrays, and everything
+// that is indexed by body and kept across steps follows the live ones
+static void CompactBodies() {
+    if (bodies.RemovedCount() == 0) return;
+    ++stepsSinceRemoval;
+    if (bodies.RemovedCount() * COMPACT_FRACTION < bodies.Count() && stepsSinceRemoval < COMPACT_MAX_STEPS) return;
+
+    bodies.Compact();
+    const vector<int>& remap = bodies.LastRemap();
+    manifoldCache.Remap(remap);
+    broadphaseSap.Remap(remap);
+    broadphaseTree.Remap(remap);
+    for (BroadphaseProxy& p : broadphaseProxies) p.body = (p.body >= 0) ? remap[p.body] : -1;   // for queries until the next step
+    stepsSinceRemoval = 0;
+}
+
+void InvalidateBroadphase() {
+    broadphaseStale = true;
+}
+
+// Brings what region queries read up to date: the static index, and the
+// proxies if the last step's broadphase no longer matches the bodies
+static void PrepareQueries() {
+    UpdateStaticIndex();
+    if (!broadphaseStale && queryMode == broadphaseMode) return;
+
+    broadphaseStale = true;
+    broadphaseProxies.clear();
+    for (int i = 0; i < bodies.Count(); ++i) {
+        if (!bodies.active[i] || bodies.invMass[i] == 0.0f || bodies.shape[i].type == SHAPE_CHAIN) continue;
+        BroadphaseProxy proxy;
+        proxy.box = BodyBounds(i);
+        proxy.body = i;
+        proxy.isStatic = !bodies.awake[i];
+        broadphaseProxies.push_back(proxy);
+    }
+}
+
+// Region query over the broadphase state of the last step plus the static
+// index (PrepareQueries first). Only reads, so it is safe on several
+// threads at once.
+static void QueryRegion(const AABB& box, vector<int>& out) {
+    out.clear();
+    switch (broadphaseStale ? BROADPHASE_BRUTE_FORCE : broadphaseMode) {
+    case BROADPHASE_GRID: broadphaseGrid.Query(box, broadphaseProxies, out); break;
+    case BROADPHASE_SAP:  broadphaseSap.Query(box, broadphaseProxies, out);  break;
+    case BROADPHASE_TREE: broadphaseTree.Query(box, out);                    break;
+    default:              BruteForceQuery(broadphaseProxies, box, out);      break;
+    }
+    staticIndex.Query(box, out);
+
+    // bodies removed since the step still have their proxies
+    out.erase(remove_if(out.begin(), out.end(),
+        [](int i) { return i >= bodies.Count() || !bodies.active[i]; }), out.end());
+    sort(out.begin(), out.end());
+}
+
+// Distance from p to body i's current box (0 inside)
+static float DistanceToBody(Vector2 p, int i) {
+    Vector2 lo, hi;
+    bodies.LocalBounds(i, lo, hi);
+    Vector2 pos = bodies.position[i];
+    float dx = max(max(pos.x + lo.x - p.x, p.x - (pos.x + hi.x)), 0.0f);
+    float dy = max(max(pos.y + lo.y - p.y, p.y - (pos.y + hi.y)), 0.0f);
+    return sqrtf(dx * dx + dy * dy);
+}
+
+static void QueryCircleRegion(Vector2 center, float radius, vector<int>& out) {
+    AABB box;
+    box.min = Vector2SubtractValue(center, radius);
+    box.max = Vector2AddValue(center, radius);
+    QueryRegion(box, out);
+    out.erase(remove_if(out.begin(), out.end(),
+        [center, radius](int i) { return DistanceToBody(center, i) > radius; }), out.end());
+}
+
+// Explosions queued since the last step, all together: their queries only
+// read the broadphase, so they run in parallel with one hit list each; the
+// impulses then go out in queue order, bodies in index order, so the result
+// does not depend on the thread count. Impulses act through the center of
+// mass (no spin).
+static void ApplyRadialImpulses() {
+    if (radialImpulses.empty()) return;
+    PrepareQueries();
+
+    const int count = (int)radialImpulses.size();
+    if ((int)radialHits.size() < count) radialHits.resize(count);
+    jobs.ParallelFor(count, RADIAL_IMPULSES_PER_JOB, [](int first, int last) {
+        for (int k = first; k < last; ++k) {
+            QueryCircleRegion(radialImpulses[k].center, radialImpulses[k].radius, radialHits[k]);
+        }
+    });
+
+    for (int k = 0; k < count; ++k) {
+        const RadialImpulse& r = radialImpulses[k];
+        for (int i : radialHits[k]) {
+            if (bodies.invMass[i] == 0.0f) continue;
+            float falloff = 1.0f - DistanceToBody(r.center, i) / r.radius;
+            Vector2 d = Vector2Subtract(bodies.position[i], r.center);
+            float len = Vector2Length(d);
+            Vector2 dir = (len > 1e-4f) ? Vector2Scale(d, 1.0f / len) : Vector2{ 0.0f, -1.0f };
+            bodies.velocity[i] = Vector2Add(bodies.velocity[i], Vector2Scale(dir, r.strength * falloff * bodies.invMass[i]));
+            IslandManager::WakeBody(bodies, i);
+        }
+    }
+    radialImpulses.clear();
+}
+
+void UpdatePhysics() {
+    const int n = bodies.Count();
+    if (deterministicMode) RecordTunableChanges();
+
+    {
+        PROFILE_SCOPE(PHASE_INTEGRATE);
+        ApplyRadialImpulses();
+
+        // Changing gravity from the GUI has to reach sleeping bodies too
+        if (gravityAcc != lastGravityAcc) {
+            IslandManager::WakeAll(bodies);
+            lastGravityAcc = gravityAcc;
+        }
+
+        // Integrate positions, then gravity (SIMD where available)
+        IntegrateBodies(bodies.position.data(), bodies.velocity.data(), bodies.invMass.data(),
+            bodies.awake.data(), n, gravityAcc, dt);
+        IntegrateRotations(bodies.rotation.data(), bodies.angularVelocity.data(), bodies.invInertia.data(),
+            bodies.awake.data(), n, dt);
+
+        // Bodies that moved far enough to skip over a thin block this step
+        ccd.enabled = ccdEnabled;
+        ccd.FindFastBodies(bodies, dt);
+    }
+
+    GenerateContacts();
+    {
+        PROFILE_SCOPE(PHASE_SLEEP);
+        islands.Build(bodies, manifoldCache.manifolds);   // wake on contact before solving
+    }
+    ResolveContacts();
+
+    PROFILE_SCOPE(PHASE_SLEEP);
+
+    // Small damping for nearly resting objects
+    DampSmallVelocities(bodies.velocity.data(), bodies.invMass.data(), bodies.awake.data(),
+        n, REST_VEL_EPS);
+    DampSmallAngularVelocities(bodies.angularVelocity.data(), bodies.invInertia.data(), bodies.awake.data(),
+        n, REST_SPIN_EPS);
+
+    // Rest timers -> islands that settled go to sleep
+    islands.UpdateSleep(bodies, dt);
+
+    RemoveLostBodies();
+    CompactBodies();
+
+    ++stepIndex;
+    if (deterministicMode) stepHashes.push_back(WorldHash());
+}
+
+// Region queries: indices of active bodies whose box overlaps the region,
+// as of the last physics step, from whichever broadphase is active and the
+// static index. Bodies added since that step are not in there yet (unless
+// the world was replaced or the mode switched since, see PrepareQueries).
+// Terrain chains have no broadphase proxy, so they are left out.
+void QueryAABB(Rectangle region, vector<int>& out) {
+    AABB box;
+    box.min = { region.x, region.y };
+    box.max = { region.x + region.width, region.y + region.height };
+    PrepareQueries();
+    QueryRegion(box, out);
+}
+
+void QueryCircle(Vector2 center, float radius, vector<int>& out) {
+    PrepareQueries();
+    QueryCircleRegion(center, radius, out);
+}
+
+// FNV-1a, one 32-bit word at a time
+static inline void HashWord(uint64_t& h, uint32_t word) {
+    h ^= word;
+    h *= 1099511628211ull;
+}
+
+static inline uint32_t FloatBits(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+uint64_t WorldHash() {
+    uint64_t h = 14695981039346656037ull;
+    const int n = bodies.Count();
+    HashWord(h, (uint32_t)n);
+
+    for (int i = 0; i < n; ++i) {
+        HashWord(h, FloatBits(bodies.position[i].x));
+        HashWord(h, FloatBits(bodies.position[i].y));
+        HashWord(h, FloatBits(bodies.rotation[i].x));
+        HashWord(h, FloatBits(bodies.rotation[i].y));
+        HashWord(h, FloatBits(bodies.velocity[i].x));
+        HashWord(h, FloatBits(bodies.velocity[i].y));
+        HashWord(h, FloatBits(bodies.angularVelocity[i]));
+        HashWord(h, (uint32_t)bodies.active[i] | ((uint32_t)bodies.awake[i] << 1) |
+            ((uint32_t)bodies.game[i].alive << 2));
+    }
+    return h;
+}
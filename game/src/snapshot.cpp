@@ -0,0 +1,395 @@
+#include "fp_mode.h"
+#include "snapshot.h"
+#include "simulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+const uint8_t FLAG_ACTIVE = 1 << 0;
+const uint8_t FLAG_AWAKE = 1 << 1;
+const uint8_t FLAG_ALIVE = 1 << 2;
+const uint8_t FLAG_REMOVED = 1 << 3;    // waiting for BodyStore::Compact
+const uint8_t FLAG_CHANGED = 1 << 7;    // delta: quantized state follows
+
+const size_t HEADER_BYTES = 28;
+const size_t MAX_VARINT_BYTES = 5;
+const size_t MIN_KEY_BODY_BYTES = 3 + 4 + 4 + 9 * 4 + SNAPSHOT_LANES;   // every varint at least one byte
+const size_t MAX_KEY_BODY_BYTES = 3 + 4 + 4 + 9 * 4 + SNAPSHOT_LANES * MAX_VARINT_BYTES;
+const size_t MIN_POLYGON_BYTES = 1 + 4;
+const size_t MAX_POLYGON_BYTES = 1 + MAX_POLYGON_VERTICES * 2 * sizeof(Vector2) + 4;
+const size_t MAX_DELTA_BODY_BYTES = 1 + SNAPSHOT_LANES * MAX_VARINT_BYTES;
+
+// ------------------------------------------------------------
+// Byte stream helpers. Writers size the blob for the worst case up front,
+// write through a cursor and trim at the end, so the per-body loops don't
+// go through vector growth checks.
+
+static inline void Put(uint8_t*& p, const void* data, size_t size) {
+    memcpy(p, data, size);
+    p += size;
+}
+
+static inline void PutU8(uint8_t*& p, uint8_t v)   { *p++ = v; }
+static inline void PutU16(uint8_t*& p, uint16_t v) { Put(p, &v, sizeof(v)); }
+static inline void PutU32(uint8_t*& p, uint32_t v) { Put(p, &v, sizeof(v)); }
+static inline void PutF32(uint8_t*& p, float v)    { Put(p, &v, sizeof(v)); }
+
+// zigzag (small magnitudes -> small codes), then 7 bits per byte
+static inline void PutVarint(uint8_t*& p, int32_t v) {
+    uint32_t z = ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+    while (z >= 0x80) {
+        *p++ = (uint8_t)(z | 0x80);
+        z >>= 7;
+    }
+    *p++ = (uint8_t)z;
+}
+
+// Bounds-checked reader; any overrun clears ok and reads zeros from then on
+struct Reader {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok = true;
+
+    Reader(const vector<uint8_t>& blob) : p(blob.data()), end(blob.data() + blob.size()) {}
+
+    size_t Remaining() const { return (size_t)(end - p); }
+
+    void Get(void* data, size_t size) {
+        if (!ok || Remaining() < size) {
+            ok = false;
+            memset(data, 0, size);
+            return;
+        }
+        memcpy(data, p, size);
+        p += size;
+    }
+
+    uint8_t  U8()  { uint8_t v;  Get(&v, sizeof(v)); return v; }
+    uint16_t U16() { uint16_t v; Get(&v, sizeof(v)); return v; }
+    uint32_t U32() { uint32_t v; Get(&v, sizeof(v)); return v; }
+    float    F32() { float v;    Get(&v, sizeof(v)); return v; }
+
+    int32_t Varint() {
+        uint32_t z = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            uint8_t b = U8();
+            z |= (uint32_t)(b & 0x7F) << shift;
+            if (!(b & 0x80)) return (int32_t)((z >> 1) ^ (0u - (z & 1)));
+        }
+        ok = false;   // more than 5 bytes: not one of ours
+        return 0;
+    }
+};
+
+struct SnapshotHeader {
+    uint16_t kind = SNAPSHOT_KEY;
+    uint32_t bodyCount = 0;
+    uint32_t step = 0;
+    float    time = 0.0f;
+    int32_t  lastBird = -1;
+    uint32_t layout = 0;
+};
+
+static void PutHeader(uint8_t*& out, SnapshotKind kind) {
+    PutU32(out, SNAPSHOT_MAGIC);
+    PutU16(out, SNAPSHOT_VERSION);
+    PutU16(out, (uint16_t)kind);
+    PutU32(out, (uint32_t)bodies.Count());
+    PutU32(out, stepIndex);
+    PutF32(out, timeElapsed);
+    PutU32(out, (uint32_t)bodies.IndexOf(lastBird));
+    PutU32(out, bodies.LayoutVersion());
+}
+
+static bool GetHeader(Reader& r, SnapshotHeader& h) {
+    if (r.U32() != SNAPSHOT_MAGIC || r.U16() != SNAPSHOT_VERSION) return false;
+    h.kind = r.U16();
+    h.bodyCount = r.U32();
+    h.step = r.U32();
+    h.time = r.F32();
+    h.lastBird = (int32_t)r.U32();
+    h.layout = r.U32();
+    return r.ok;
+}
+
+// ------------------------------------------------------------
+// Quantization
+
+static inline int32_t Quantize(float v, float scale) {
+    float q = v * scale;
+    if (q != q) return 0;   // NaN
+    return (int32_t)lrintf(min(max(q, -2.0e9f), 2.0e9f));
+}
+
+void QuantizeBodies(const BodyStore& bodies, vector<int32_t>& out) {
+    const int n = bodies.Count();
+    out.resize((size_t)n * SNAPSHOT_LANES);
+    for (int i = 0; i < n; ++i) {
+        int32_t* q = &out[(size_t)i * SNAPSHOT_LANES];
+        q[0] = Quantize(bodies.position[i].x, SNAPSHOT_POSITION_SCALE);
+        q[1] = Quantize(bodies.position[i].y, SNAPSHOT_POSITION_SCALE);
+        q[2] = Quantize(AngleOf(bodies.rotation[i]), SNAPSHOT_ANGLE_SCALE);
+        q[3] = Quantize(bodies.velocity[i].x, SNAPSHOT_VELOCITY_SCALE);
+        q[4] = Quantize(bodies.velocity[i].y, SNAPSHOT_VELOCITY_SCALE);
+        q[5] = Quantize(bodies.angularVelocity[i], SNAPSHOT_SPIN_SCALE);
+        q[6] = Quantize(bodies.sleepTime[i], SNAPSHOT_SLEEP_SCALE);
+    }
+}
+
+static inline uint8_t BodyFlags(int i) {
+    return (bodies.active[i] ? FLAG_ACTIVE : 0) | (bodies.awake[i] ? FLAG_AWAKE : 0) |
+        (bodies.game[i].alive ? FLAG_ALIVE : 0) | (bodies.IsRemoved(i) ? FLAG_REMOVED : 0);
+}
+
+// ------------------------------------------------------------
+// Save
+
+void SaveSnapshot(vector<uint8_t>& out, SnapshotKeyState* keyState) {
+    static SnapshotKeyState scratch;
+    SnapshotKeyState& key = keyState ? *keyState : scratch;
+    QuantizeBodies(bodies, key.state);
+    key.layout = bodies.LayoutVersion();
+    const vector<int32_t>& state = key.state;
+
+    const int n = bodies.Count();
+    const int polygonCount = (int)bodies.polygons.size();
+    out.resize(HEADER_BYTES + 4 + (size_t)polygonCount * MAX_POLYGON_BYTES + (size_t)n * MAX_KEY_BODY_BYTES);
+    uint8_t* p = out.data();
+    PutHeader(p, SNAPSHOT_KEY);
+
+    PutU32(p, (uint32_t)polygonCount);
+    for (const ConvexPolygon& poly : bodies.polygons) {
+        PutU8(p, (uint8_t)poly.count);
+        Put(p, poly.vertices, poly.count * sizeof(Vector2));
+        Put(p, poly.normals, poly.count * sizeof(Vector2));
+        PutF32(p, poly.radius);
+    }
+
+    for (int i = 0; i < n; ++i) {
+        const BodyShape& s = bodies.shape[i];
+        const BodyMaterial& m = bodies.material[i];
+        const BodyGameData& g = bodies.game[i];
+
+        PutU8(p, (uint8_t)s.type);
+        PutU8(p, (uint8_t)g.type);
+        PutU8(p, BodyFlags(i));
+        Put(p, &g.color, 4);
+        PutU32(p, (uint32_t)((s.type == SHAPE_CHAIN) ? s.chain : s.polygon));
+        PutF32(p, s.radius);
+        PutF32(p, s.halfExtents.x);
+        PutF32(p, s.halfExtents.y);
+        PutF32(p, m.mass);
+        PutF32(p, bodies.invMass[i]);
+        PutF32(p, bodies.invInertia[i]);
+        PutF32(p, m.restitution);
+        PutF32(p, m.friction);
+        PutF32(p, g.toughness);
+
+        const int32_t* q = &state[(size_t)i * SNAPSHOT_LANES];
+        for (int l = 0; l < SNAPSHOT_LANES; ++l) PutVarint(p, q[l]);
+    }
+    out.resize((size_t)(p - out.data()));
+}
+
+bool SaveDeltaSnapshot(const SnapshotKeyState& keyState, vector<uint8_t>& out) {
+    const int n = bodies.Count();
+    if (keyState.layout != bodies.LayoutVersion()) return false;
+    if (keyState.state.size() != (size_t)n * SNAPSHOT_LANES) return false;
+
+    static vector<int32_t> state;
+    QuantizeBodies(bodies, state);
+
+    out.resize(HEADER_BYTES + (size_t)n * MAX_DELTA_BODY_BYTES);
+    uint8_t* p = out.data();
+    PutHeader(p, SNAPSHOT_DELTA);
+
+    for (int i = 0; i < n; ++i) {
+        const int32_t* q = &state[(size_t)i * SNAPSHOT_LANES];
+        const int32_t* k = &keyState.state[(size_t)i * SNAPSHOT_LANES];
+        bool changed = memcmp(q, k, SNAPSHOT_LANES * sizeof(int32_t)) != 0;
+
+        PutU8(p, BodyFlags(i) | (changed ? FLAG_CHANGED : 0));
+        if (!changed) continue;
+        for (int l = 0; l < SNAPSHOT_LANES; ++l) PutVarint(p, (int32_t)((uint32_t)q[l] - (uint32_t)k[l]));
+    }
+    out.resize((size_t)(p - out.data()));
+    return true;
+}
+
+// ------------------------------------------------------------
+// Restore
+
+bool RestoreSnapshot(const vector<uint8_t>& key, const vector<uint8_t>* delta) {
+    Reader r(key);
+    SnapshotHeader h;
+    if (!GetHeader(r, h) || h.kind != SNAPSHOT_KEY) return false;
+
+    const uint32_t polygonCount = r.U32();
+    if (r.Remaining() / MIN_POLYGON_BYTES < polygonCount) return false;   // corrupt count
+    vector<ConvexPolygon> polygons(polygonCount);
+    for (ConvexPolygon& poly : polygons) {
+        poly.count = r.U8();
+        if (poly.count < 3 || poly.count > MAX_POLYGON_VERTICES) return false;
+        r.Get(poly.vertices, poly.count * sizeof(Vector2));
+        r.Get(poly.normals, poly.count * sizeof(Vector2));
+        poly.radius = r.F32();
+    }
+    if (!r.ok || r.Remaining() / MIN_KEY_BODY_BYTES < h.bodyCount) return false;   // corrupt count
+
+    const int n = (int)h.bodyCount;
+    vector<Body> list(n);
+    vector<uint8_t> flags(n);
+    vector<int32_t> state((size_t)n * SNAPSHOT_LANES);
+
+    for (int i = 0; i < n && r.ok; ++i) {
+        Body& b = list[i];
+        uint8_t shape = r.U8(), type = r.U8();
+        if (shape > SHAPE_CHAIN || type > OBJ_STATIC_TERRAIN) return false;
+        b.shape = (ShapeType)shape;
+        b.type = (ObjectType)type;
+        flags[i] = r.U8();
+        r.Get(&b.color, 4);
+        int32_t polygon = (int32_t)r.U32();   // or chain
+        if (b.shape == SHAPE_POLYGON) {
+            if (polygon < 0 || (uint32_t)polygon >= polygonCount) return false;
+            b.polygon = polygons[polygon];
+        }
+        if (b.shape == SHAPE_CHAIN) {
+            if (polygon < 0 || polygon >= terrain.ChainCount()) return false;
+            b.chain = polygon;
+        }
+        b.radius = r.F32();
+        b.halfExtents.x = r.F32();
+        b.halfExtents.y = r.F32();
+        b.mass = r.F32();
+        b.invMass = r.F32();
+        b.invInertia = r.F32();
+        b.restitution = r.F32();
+        b.friction = r.F32();
+        b.toughness = r.F32();
+
+        int32_t* q = &state[(size_t)i * SNAPSHOT_LANES];
+        for (int l = 0; l < SNAPSHOT_LANES; ++l) q[l] = r.Varint();
+    }
+    if (!r.ok) return false;
+
+    if (delta) {
+        // same count is not enough: a spawn and a removal in one step keep
+        // the count but put other bodies at the indices
+        const uint32_t keyLayout = h.layout;
+        Reader d(*delta);
+        if (!GetHeader(d, h) || h.kind != SNAPSHOT_DELTA || h.bodyCount != (uint32_t)n || h.layout != keyLayout) {
+            return false;
+        }
+
+        for (int i = 0; i < n && d.ok; ++i) {
+            flags[i] = d.U8();
+            if (!(flags[i] & FLAG_CHANGED)) continue;
+            int32_t* q = &state[(size_t)i * SNAPSHOT_LANES];
+            for (int l = 0; l < SNAPSHOT_LANES; ++l) q[l] = (int32_t)((uint32_t)q[l] + (uint32_t)d.Varint());
+        }
+        if (!d.ok) return false;
+    }
+
+    // Everything parsed: now replace the world
+    bodies.Clear();
+    bodies.Reserve(n);
+    for (int i = 0; i < n; ++i) {
+        Body& b = list[i];
+        const int32_t* q = &state[(size_t)i * SNAPSHOT_LANES];
+        b.position = { q[0] / SNAPSHOT_POSITION_SCALE, q[1] / SNAPSHOT_POSITION_SCALE };
+        b.angle = q[2] / SNAPSHOT_ANGLE_SCALE;
+        b.velocity = { q[3] / SNAPSHOT_VELOCITY_SCALE, q[4] / SNAPSHOT_VELOCITY_SCALE };
+        b.angularVelocity = q[5] / SNAPSHOT_SPIN_SCALE;
+        b.active = (flags[i] & FLAG_ACTIVE) != 0;
+        b.alive = (flags[i] & FLAG_ALIVE) != 0;
+        bodies.Add(b);
+
+        bodies.awake[i] = (flags[i] & FLAG_AWAKE) ? 1 : 0;
+        bodies.sleepTime[i] = q[6] / SNAPSHOT_SLEEP_SCALE;
+        if (flags[i] & FLAG_REMOVED) bodies.RemoveAt(i);   // same indices as recorded; the next compaction drops it
+    }
+
+    stepIndex = h.step;
+    timeElapsed = h.time;
+    lastBird = (h.lastBird >= 0 && h.lastBird < n) ? bodies.HandleOf(h.lastBird) : BodyHandle();
+    manifoldCache.Clear();
+    contactEvents.Clear();
+    InvalidateBroadphase();
+    return true;
+}
+
+// ------------------------------------------------------------
+// History
+
+void SnapshotHistory::Reset(int capacity) {
+    ring.resize(max(1, capacity));
+    head = 0;
+    count = 0;
+    newestKey = -1;
+    sinceKey = 0;
+    keyCount = 0;
+}
+
+// The oldest entry is always a keyframe; it leaves together with its deltas
+void SnapshotHistory::DropOldest() {
+    --count;
+    --keyCount;
+    while (count > 0) {
+        int slot = Slot(count - 1);
+        if (ring[slot].key == slot) break;
+        --count;
+    }
+    if (count == 0) newestKey = -1;
+}
+
+void SnapshotHistory::Record() {
+    if (ring.empty()) return;
+    if (count == (int)ring.size()) DropOldest();
+
+    Entry& e = ring[head];
+    bool key = newestKey < 0 || sinceKey + 1 >= keyframeInterval || !SaveDeltaSnapshot(keyState, e.blob);
+    if (key) {
+        SaveSnapshot(e.blob, &keyState);
+        e.key = head;
+        newestKey = head;
+        sinceKey = 0;
+        ++keyCount;
+    }
+    else {
+        e.key = newestKey;
+        ++sinceKey;
+    }
+
+    head = (head + 1) % (int)ring.size();
+    ++count;
+}
+
+int SnapshotHistory::Rewind(int steps) {
+    if (count == 0) return 0;
+    steps = min(max(steps, 0), count - 1);
+
+    int slot = Slot(steps);
+    const Entry& e = ring[slot];
+    bool ok = (e.key == slot) ? RestoreSnapshot(e.blob) : RestoreSnapshot(ring[e.key].blob, &e.blob);
+    if (!ok) return 0;
+
+    // forget the newer steps; the next Record starts a fresh keyframe
+    for (int age = 0; age < steps; ++age) {
+        int s = Slot(age);
+        if (ring[s].key == s) --keyCount;
+    }
+    count -= steps;
+    head = (slot + 1) % (int)ring.size();
+    newestKey = -1;
+    return steps;
+}
+
+size_t SnapshotHistory::Bytes() const {
+    size_t total = 0;
+    for (int age = 0; age < count; ++age) total += ring[Slot(age)].blob.size();
+    return total;
+}
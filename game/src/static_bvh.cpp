@@ -0,0 +1,102 @@
+#include "fp_mode.h"
+#include "static_bvh.h"
+#include "raymath.h"
+
+#include <algorithm>
+
+using namespace std;
+
+void StaticBVH::Build(const AABB* itemBoxes, int count) {
+    Clear();
+    if (count <= 0) return;
+    items.resize(count);
+    for (int i = 0; i < count; ++i) items[i] = i;
+    nodes.reserve(2 * (count / STATIC_BVH_LEAF_ITEMS) + 1);
+    BuildNode(itemBoxes, 0, count);
+
+    boxes.resize(count);
+    for (int s = 0; s < count; ++s) boxes[s] = itemBoxes[items[s]];
+}
+
+// Top down: split the items at the median of their box centers along the
+// wider axis of those centers
+int StaticBVH::BuildNode(const AABB* itemBoxes, int first, int count) {
+    const int id = (int)nodes.size();
+    nodes.emplace_back();
+
+    AABB box = itemBoxes[items[first]];
+    AABB centers;
+    centers.min = centers.max = Vector2Scale(Vector2Add(box.min, box.max), 0.5f);
+    for (int i = first + 1; i < first + count; ++i) {
+        const AABB& b = itemBoxes[items[i]];
+        Vector2 c = Vector2Scale(Vector2Add(b.min, b.max), 0.5f);
+        box.min = Vector2Min(box.min, b.min);
+        box.max = Vector2Max(box.max, b.max);
+        centers.min = Vector2Min(centers.min, c);
+        centers.max = Vector2Max(centers.max, c);
+    }
+    nodes[id].box = box;
+
+    if (count <= STATIC_BVH_LEAF_ITEMS) {
+        nodes[id].first = first;
+        nodes[id].count = count;
+        return id;
+    }
+
+    const bool splitX = (centers.max.x - centers.min.x) >= (centers.max.y - centers.min.y);
+    const int half = count / 2;
+    nth_element(items.begin() + first, items.begin() + first + half, items.begin() + first + count,
+        [itemBoxes, splitX](int l, int r) {
+            const AABB& a = itemBoxes[l];
+            const AABB& b = itemBoxes[r];
+            return splitX ? (a.min.x + a.max.x < b.min.x + b.max.x) : (a.min.y + a.max.y < b.min.y + b.max.y);
+        });
+
+    BuildNode(itemBoxes, first, half);
+    int right = BuildNode(itemBoxes, first + half, count - half);
+    nodes[id].first = right;
+    nodes[id].count = 0;
+    return id;
+}
+
+void StaticBVH::Clear() {
+    nodes.clear();
+    items.clear();
+    boxes.clear();
+}
+
+// ------------------------------------------------------------
+// Static partition
+
+void StaticBodyIndex::Build(const vector<int>& bodies, const vector<AABB>& bodyBoxes) {
+    body = bodies;
+    tree.Build(bodyBoxes.data(), (int)bodyBoxes.size());
+}
+
+void StaticBodyIndex::Clear() {
+    body.clear();
+    tree.Clear();
+}
+
+void StaticBodyIndex::FindPairs(const vector<BroadphaseProxy>& proxies, vector<BodyPair>& pairs) {
+    staticPairs.clear();
+    for (const BroadphaseProxy& p : proxies) {
+        if (p.isStatic) continue;
+        tree.Query(p.box, [&](int item) {
+            int s = body[item];
+            if (p.body < s) staticPairs.push_back({ p.body, s });
+            else            staticPairs.push_back({ s, p.body });
+        });
+    }
+    pairCount = (int)staticPairs.size();
+    if (staticPairs.empty()) return;
+
+    sort(staticPairs.begin(), staticPairs.end());
+    merged.resize(pairs.size() + staticPairs.size());
+    merge(pairs.begin(), pairs.end(), staticPairs.begin(), staticPairs.end(), merged.begin());
+    pairs.swap(merged);
+}
+
+void StaticBodyIndex::Query(const AABB& region, vector<int>& out) const {
+    tree.Query(region, [&](int item) { out.push_back(body[item]); });
+}
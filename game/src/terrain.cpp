@@ -0,0 +1,77 @@
+#include "fp_mode.h"
+#include "terrain.h"
+#include "raymath.h"
+
+#include <vector>
+
+using namespace std;
+
+// Joints bending less than this (sine of the angle) count as flat
+const float TERRAIN_BEND_EPS = 1e-3f;
+
+static AABB BoundsOf(const Vector2* p, int count) {
+    AABB box;
+    box.min = box.max = p[0];
+    for (int i = 1; i < count; ++i) {
+        box.min = Vector2Min(box.min, p[i]);
+        box.max = Vector2Max(box.max, p[i]);
+    }
+    return box;
+}
+
+int Terrain::AddChain(const Vector2* chainPoints, int count) {
+    if (count < 2) return -1;
+
+    TerrainChain chain;
+    chain.first = (int)points.size();
+    chain.count = count;
+    chain.box = BoundsOf(chainPoints, count);
+    const int index = (int)chains.size();
+    chains.push_back(chain);
+    points.insert(points.end(), chainPoints, chainPoints + count);
+
+    const size_t firstSegment = segments.size();
+    for (int i = 0; i + 1 < count; ++i) {
+        Vector2 e = Vector2Subtract(chainPoints[i + 1], chainPoints[i]);
+        float len = Vector2Length(e);
+        if (len < 1e-4f) continue;
+
+        TerrainSegment s;
+        s.v1 = chainPoints[i];
+        s.v2 = chainPoints[i + 1];
+        s.normal = { e.y / len, -e.x / len };
+        Vector2 back = Vector2Scale(s.normal, -TERRAIN_DEPTH);
+        Vector2 corners[4] = { s.v1, s.v2, Vector2Add(s.v1, back), Vector2Add(s.v2, back) };
+        s.box = BoundsOf(corners, 4);
+        s.chain = index;
+        segments.push_back(s);
+    }
+
+    // link neighbours: the next segment's direction, and which corners are
+    // convex (the next segment turns behind this one's normal)
+    for (size_t i = firstSegment; i < segments.size(); ++i) {
+        TerrainSegment& s = segments[i];
+        s.startCorner = (i == firstSegment);
+        if (i + 1 == segments.size()) {
+            s.endCorner = true;
+            continue;
+        }
+        s.next = Vector2Normalize(Vector2Subtract(segments[i + 1].v2, segments[i + 1].v1));
+        s.endCorner = Vector2DotProduct(s.normal, s.next) < -TERRAIN_BEND_EPS;
+    }
+    bvh.Clear();   // stale until the next Build
+    return index;
+}
+
+void Terrain::Build() {
+    vector<AABB> boxes(segments.size());
+    for (size_t i = 0; i < segments.size(); ++i) boxes[i] = segments[i].box;
+    bvh.Build(boxes.data(), (int)boxes.size());
+}
+
+void Terrain::Clear() {
+    points.clear();
+    chains.clear();
+    segments.clear();
+    bvh.Clear();
+}
@@ -0,0 +1,397 @@
+// Headless runner: builds a scene, fires a scripted sequence of birds and
+// steps the simulation as fast as it can, with no window. Prints per-step
+// timing (total and per phase) and the final state of every body.
+//
+//   headless [--scene NAME] [--bodies N] [--steps N] [--hz HZ] [--threads N]
+//            [--broadphase brute|grid|sap|tree] [--no-ccd] [--quiet]
+//            [--launch STEP:VX,VY[:square]]... [--explode STEP:X,Y:RADIUS:STRENGTH]...
+//            [--script FILE] [--trace FILE] [--hash-log FILE] [--level FILE] [--save-level FILE]
+//   headless --verify A.log B.log
+//   headless --compile-level LEVEL.txt LEVEL.plvl
+//   headless --check-snapshots
+//
+// A script file has one event per line, "step vx vy [circle|square]" for a
+// launch, "step explode x y radius strength" for an explosion or
+// "step set name value" for a tunable (see replay.h); settings at
+// step 0 are applied before the scene is built. Replays saved from the game
+// (F5) are scripts of the fort scene.
+//
+// --hash-log writes the world hash after every step; --verify compares two
+// hash logs and reports the first step where the runs diverge.
+//
+// --check-snapshots records a small world through SnapshotHistory across a
+// step that spawns a bird and removes a pig (same body count, shifted
+// indices), rewinds to it and checks every body came back where it was.
+//
+// --level runs a level file (binary or text, see level.h) instead of a
+// scene; --save-level writes the built world as a binary level before the
+// first step, which is how large stress levels are made from the scenes.
+#include "level.h"
+#include "profiler.h"
+#include "scenes.h"
+#include "simulation.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+// fort and empty ignore the body count; the rest are the synthetic scenes
+struct Scene {
+    const char* name;
+    void (*build)(int bodyCount);
+};
+
+static const Scene scenes[] = {
+    { "fort",     [](int) { BuildWorld(); } },
+    { "empty",    [](int) { ClearWorld(); } },
+    { "pyramids", [](int n) { BuildScene(SCENE_PYRAMIDS, n); } },
+    { "ballpit",  [](int n) { BuildScene(SCENE_BALL_PIT, n); } },
+    { "forts",    [](int n) { BuildScene(SCENE_FORTS, n); } },
+    { "debris",   [](int n) { BuildScene(SCENE_DEBRIS, n); } },
+    { "hills",    [](int n) { BuildScene(SCENE_HILLS, n); } },
+};
+
+static double NowMs() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count() * 1e-6;
+}
+
+// STEP:VX,VY[:square]
+static bool ParseLaunch(const char* arg, ReplayEvent& out) {
+    char type[16] = "";
+    int n = sscanf(arg, "%u:%f,%f:%15s", &out.step, &out.velocity.x, &out.velocity.y, type);
+    if (n < 3) return false;
+    out.kind = REPLAY_LAUNCH;
+    out.birdType = (strcmp(type, "square") == 0) ? 1 : 0;
+    return true;
+}
+
+// STEP:X,Y:RADIUS:STRENGTH
+static bool ParseExplode(const char* arg, ReplayEvent& out) {
+    int n = sscanf(arg, "%u:%f,%f:%f:%f", &out.step, &out.position.x, &out.position.y, &out.radius, &out.strength);
+    if (n != 5) return false;
+    out.kind = REPLAY_EXPLODE;
+    return true;
+}
+
+// Compare two hash logs step by step; 0 if they match
+static int VerifyHashLogs(const char* pathA, const char* pathB) {
+    vector<uint64_t> a, b;
+    if (!LoadHashLog(pathA, a) || !LoadHashLog(pathB, b)) {
+        fprintf(stderr, "could not read %s\n", a.empty() ? pathA : pathB);
+        return 1;
+    }
+
+    size_t common = min(a.size(), b.size());
+    for (size_t i = 0; i < common; ++i) {
+        if (a[i] != b[i]) {
+            printf("diverged at step %zu: %016llx vs %016llx (%zu steps matched)\n", i,
+                (unsigned long long)a[i], (unsigned long long)b[i], i);
+            return 1;
+        }
+    }
+    if (a.size() != b.size()) {
+        printf("first %zu steps match, then %s ends (%zu vs %zu steps)\n", common,
+            a.size() < b.size() ? pathA : pathB, a.size(), b.size());
+        return 1;
+    }
+    printf("identical: %zu steps\n", common);
+    return 0;
+}
+
+// Bodies a restored snapshot has to give back: what sits at each index
+static bool SameBodies(const vector<Body>& before, int& firstBad) {
+    firstBad = -1;
+    if ((int)before.size() != bodies.Count()) return false;
+    for (int i = 0; i < bodies.Count(); ++i) {
+        const Body& a = before[i];
+        const Body b = bodies.Get(i);
+        bool same = a.type == b.type && a.shape == b.shape && a.active == b.active &&
+            fabsf(a.position.x - b.position.x) <= 1.0f / SNAPSHOT_POSITION_SCALE &&
+            fabsf(a.position.y - b.position.y) <= 1.0f / SNAPSHOT_POSITION_SCALE;
+        if (!same) {
+            firstBad = i;
+            return false;
+        }
+    }
+    return true;
+}
+
+// 15 bodies with the pig last; one step later a bird takes the pig's index
+static int CheckSnapshots() {
+    ClearWorld();
+    for (int i = 0; i < 13; ++i) {
+        Vector2 pos = { 700.0f + 60.0f * (i % 7), groundY - 25.0f - 52.0f * (i / 7) };
+        bodies.Add(MakeBox(OBJ_BLOCK, pos, { 25.0f, 25.0f }, 4.0f, BROWN));
+    }
+    Body pig = MakeCircle(OBJ_PIG, { 400.0f, groundY - 15.0f }, 15.0f, 1.5f, GREEN);
+    pig.toughness = 1.0e9f;   // only the check kills it
+    BodyHandle pigHandle = bodies.Add(pig);
+
+    SnapshotHistory history;
+    history.Reset(64);
+    for (int step = 0; step < 5; ++step) {
+        UpdatePhysics();
+        history.Record();
+    }
+
+    // the pig dies and a bird is launched in the same step: the step
+    // removes the one, compacts, and the bird lands on the pig's index
+    bodies.game[bodies.IndexOf(pigHandle)].alive = false;
+    SpawnBird({ 300.0f, -200.0f }, 1);
+    UpdatePhysics();
+    history.Record();
+
+    vector<Body> before(bodies.Count());
+    for (int i = 0; i < bodies.Count(); ++i) before[i] = bodies.Get(i);
+
+    int firstBad = -1;
+    bool ok = history.Rewind(0) == 0 && SameBodies(before, firstBad);
+    if (!ok) {
+        if (firstBad >= 0) printf("rewind: body %i came back wrong\n", firstBad);
+        else printf("rewind: %i bodies, expected %i\n", bodies.Count(), (int)before.size());
+        return 1;
+    }
+    printf("snapshots: ok (%i bodies, %i keyframes in %i steps)\n", bodies.Count(), history.keyCount, history.Count());
+    return 0;
+}
+
+static bool ParseBroadphase(const char* s, BroadphaseMode& out) {
+    const char* names[BROADPHASE_COUNT] = { "brute", "grid", "sap", "tree" };
+    for (int i = 0; i < BROADPHASE_COUNT; ++i) {
+        if (strcmp(s, names[i]) == 0) {
+            out = (BroadphaseMode)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static const char* ObjectTypeName(ObjectType t) {
+    switch (t) {
+    case OBJ_BIRD:           return "bird";
+    case OBJ_BLOCK:          return "block";
+    case OBJ_PIG:            return "pig";
+    case OBJ_STATIC_TERRAIN: return "terrain";
+    default:                 return "?";
+    }
+}
+
+static const char* ShapeTypeName(ShapeType t) {
+    switch (t) {
+    case SHAPE_CIRCLE:  return "circle";
+    case SHAPE_AABB:    return "aabb";
+    case SHAPE_POLYGON: return "polygon";
+    case SHAPE_CHAIN:   return "chain";
+    default:            return "?";
+    }
+}
+
+static void PrintUsage() {
+    printf("usage: headless [--scene NAME] [--bodies N] [--steps N] [--hz HZ] [--threads N]\n"
+           "                [--broadphase brute|grid|sap|tree] [--no-ccd] [--quiet]\n"
+           "                [--launch STEP:VX,VY[:square]]... [--explode STEP:X,Y:RADIUS:STRENGTH]...\n"
+           "                [--script FILE] [--trace FILE] [--hash-log FILE] [--level FILE] [--save-level FILE]\n"
+           "       headless --verify A.log B.log\n"
+           "       headless --compile-level LEVEL.txt LEVEL.plvl\n"
+           "       headless --check-snapshots\n"
+           "scenes:");
+    for (const Scene& s : scenes) printf(" %s", s.name);
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    const Scene* scene = &scenes[0];
+    int bodyCount = 1000;
+    int steps = 500;
+    int threads = 1;
+    bool quiet = false;
+    const char* tracePath = nullptr;
+    const char* hashLogPath = nullptr;
+    const char* levelPath = nullptr;
+    const char* saveLevelPath = nullptr;
+    vector<ReplayEvent> events;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        bool ok = true;
+
+        if (strcmp(arg, "--quiet") == 0)       quiet = true;
+        else if (strcmp(arg, "--no-ccd") == 0) ccdEnabled = false;
+        else if (strcmp(arg, "--check-snapshots") == 0) return CheckSnapshots();
+        else if (!next)                        ok = false;
+        else if (strcmp(arg, "--steps") == 0)   { steps = atoi(next); ++i; }
+        else if (strcmp(arg, "--bodies") == 0)  { bodyCount = atoi(next); ++i; }
+        else if (strcmp(arg, "--hz") == 0)      { physicsHz = (float)atof(next); ++i; }
+        else if (strcmp(arg, "--threads") == 0) { threads = atoi(next); ++i; }
+        else if (strcmp(arg, "--broadphase") == 0) { ok = ParseBroadphase(next, broadphaseMode); ++i; }
+        else if (strcmp(arg, "--script") == 0)  { ok = LoadReplayScript(next, events); ++i; }
+        else if (strcmp(arg, "--trace") == 0)   { tracePath = next; ++i; }
+        else if (strcmp(arg, "--hash-log") == 0) { hashLogPath = next; ++i; }
+        else if (strcmp(arg, "--level") == 0)   { levelPath = next; ++i; }
+        else if (strcmp(arg, "--save-level") == 0) { saveLevelPath = next; ++i; }
+        else if (strcmp(arg, "--compile-level") == 0) {
+            if (i + 2 >= argc) ok = false;
+            else return CompileLevelFile(argv[i + 1], argv[i + 2]) ? 0 : 1;
+        }
+        else if (strcmp(arg, "--verify") == 0) {
+            if (i + 2 >= argc) ok = false;
+            else return VerifyHashLogs(argv[i + 1], argv[i + 2]);
+        }
+        else if (strcmp(arg, "--launch") == 0) {
+            ReplayEvent e;
+            ok = ParseLaunch(next, e);
+            if (ok) events.push_back(e);
+            ++i;
+        }
+        else if (strcmp(arg, "--explode") == 0) {
+            ReplayEvent e;
+            ok = ParseExplode(next, e);
+            if (ok) events.push_back(e);
+            ++i;
+        }
+        else if (strcmp(arg, "--scene") == 0) {
+            scene = nullptr;
+            for (const Scene& s : scenes) {
+                if (strcmp(s.name, next) == 0) scene = &s;
+            }
+            ok = (scene != nullptr);
+            ++i;
+        }
+        else ok = false;
+
+        if (!ok || steps < 0 || physicsHz <= 0.0f) {
+            fprintf(stderr, "bad argument: %s%s%s\n", arg, next ? " " : "", next ? next : "");
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    // events in step order (stable, so same-step events keep their file / command-line order)
+    stable_sort(events.begin(), events.end(),
+        [](const ReplayEvent& a, const ReplayEvent& b) { return a.step < b.step; });
+
+    // the scene is built with the step-0 settings, as in the recording
+    for (const ReplayEvent& e : events) {
+        if (e.step == 0 && e.kind == REPLAY_SET) SetTunable(e.tunable, e.value);
+    }
+
+    jobs.Start(threads);
+    dt = 1.0f / physicsHz;
+    deterministicMode = (hashLogPath != nullptr);
+    if (levelPath) {
+        double t0 = NowMs();
+        if (!LoadLevel(levelPath)) return 1;
+        printf("level %s: %i bodies in %.2f ms\n", levelPath, bodies.Count(), NowMs() - t0);
+    }
+    else scene->build(bodyCount);
+
+    if (saveLevelPath) {
+        if (!SaveWorldAsLevel(saveLevelPath)) {
+            fprintf(stderr, "could not write %s\n", saveLevelPath);
+            return 1;
+        }
+        printf("saved level %s\n", saveLevelPath);
+    }
+
+    printf("scene %s  |  bodies %i  |  steps %i  |  %.0f Hz  |  threads %i  |  %s\n",
+        levelPath ? levelPath : scene->name, bodies.Count(), steps, physicsHz, jobs.ThreadCount(), BroadphaseModeName(broadphaseMode));
+    if (!quiet) {
+        printf("%6s %10s %7s %9s %9s %8s %9s  |", "step", "ms", "pairs", "contacts", "manifolds", "islands", "sleeping");
+        for (int p = 0; p < PHASE_DRAW; ++p) printf(" %11s", ProfilePhaseName((ProfilePhase)p));
+        printf("\n");
+    }
+
+    vector<double> stepMs;
+    stepMs.reserve(steps);
+    double phaseTotal[PHASE_COUNT] = {};
+    size_t nextEvent = 0;
+    if (tracePath) profiler.StartTrace();
+
+    for (int step = 0; step < steps; ++step) {
+        // settings first: a slider moved in the same frame as a launch already applied to that bird
+        for (size_t e = nextEvent; e < events.size() && events[e].step == (uint32_t)step; ++e) {
+            if (events[e].kind == REPLAY_SET) SetTunable(events[e].tunable, events[e].value);
+        }
+        while (nextEvent < events.size() && events[nextEvent].step == (uint32_t)step) {
+            const ReplayEvent& e = events[nextEvent];
+            if (e.kind == REPLAY_LAUNCH) SpawnBird(e.velocity, e.birdType);
+            else if (e.kind == REPLAY_EXPLODE) ApplyRadialImpulse(e.position, e.radius, e.strength);
+            ++nextEvent;
+        }
+
+        double t0 = NowMs();
+        UpdatePhysics();
+        double ms = NowMs() - t0;
+        timeElapsed += dt;
+        stepMs.push_back(ms);
+        profiler.EndFrame();
+        for (int p = 0; p < PHASE_COUNT; ++p) phaseTotal[p] += profiler.Last((ProfilePhase)p);
+
+        if (!quiet) {
+            printf("%6i %10.4f %7i %9i %9i %8i %9i  |", step, ms, (int)candidatePairs.size(),
+                (int)contacts.size(), (int)manifoldCache.manifolds.size(),
+                islands.islandCount, islands.sleepingCount);
+            for (int p = 0; p < PHASE_DRAW; ++p) printf(" %11.4f", profiler.Last((ProfilePhase)p) * 1e-6);
+            printf("\n");
+        }
+    }
+
+    if (tracePath) {
+        if (profiler.StopTrace(tracePath)) printf("trace: %i events -> %s\n", profiler.TraceEventCount(), tracePath);
+        else fprintf(stderr, "could not write %s\n", tracePath);
+    }
+
+    // Timing summary
+    if (!stepMs.empty()) {
+        double total = 0.0;
+        for (double ms : stepMs) total += ms;
+        vector<double> sorted = stepMs;
+        sort(sorted.begin(), sorted.end());
+        double p99 = sorted[min(sorted.size() - 1, sorted.size() * 99 / 100)];
+        printf("timing: total %.3f ms  |  avg %.4f ms  |  min %.4f  |  p99 %.4f  |  max %.4f\n",
+            total, total / stepMs.size(), sorted.front(), p99, sorted.back());
+
+        printf("phases (avg ms):");
+        for (int p = 0; p < PHASE_DRAW; ++p) {
+            printf("  %s %.4f", ProfilePhaseName((ProfilePhase)p), phaseTotal[p] * 1e-6 / stepMs.size());
+        }
+        printf("\n");
+    }
+    if (nextEvent < events.size()) {
+        printf("note: %i event(s) scheduled after the last step were not applied\n",
+            (int)(events.size() - nextEvent));
+    }
+    if (hashLogPath) {
+        if (SaveHashLog(hashLogPath, stepHashes)) {
+            printf("hash log: %i steps -> %s  |  final %016llx\n", (int)stepHashes.size(), hashLogPath,
+                (unsigned long long)(stepHashes.empty() ? WorldHash() : stepHashes.back()));
+        }
+        else fprintf(stderr, "could not write %s\n", hashLogPath);
+    }
+
+    // Final state
+    int pigsAlive = 0;
+    for (int i = 0; i < bodies.Count(); ++i) {
+        if (bodies.active[i] && bodies.game[i].type == OBJ_PIG && bodies.game[i].alive) ++pigsAlive;
+    }
+    printf("final: time %.3f s  |  bodies %i  |  pigs alive %i\n", timeElapsed, bodies.Count(), pigsAlive);
+    printf("%5s %-8s %-7s %10s %10s %10s %10s %6s %6s\n", "body", "type", "shape", "x", "y", "vx", "vy", "awake", "active");
+    for (int i = 0; i < bodies.Count(); ++i) {
+        printf("%5i %-8s %-7s %10.3f %10.3f %10.3f %10.3f %6i %6i\n", i,
+            ObjectTypeName(bodies.game[i].type), ShapeTypeName(bodies.shape[i].type),
+            bodies.position[i].x, bodies.position[i].y, bodies.velocity[i].x, bodies.velocity[i].y,
+            (int)bodies.awake[i], (int)bodies.active[i]);
+    }
+
+    jobs.Stop();
+    return 0;
+}